@@ -0,0 +1,26 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/bin
+# Build directory: /root/repo/bin
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_base "test_base")
+set_tests_properties(test_base PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;5;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_reflector "test_reflector")
+set_tests_properties(test_reflector PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;6;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_uni "test_uni")
+set_tests_properties(test_uni PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;7;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_app "bin/test_app")
+set_tests_properties(test_app PROPERTIES  WORKING_DIRECTORY "/root/repo/bin/.." _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;8;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_xml "test_xml")
+set_tests_properties(test_xml PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;13;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_blowfish "test_blowfish")
+set_tests_properties(test_blowfish PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;14;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(shared_test "shared_test")
+set_tests_properties(shared_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;15;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_spike_cache "bin/test_spike_cache")
+set_tests_properties(test_spike_cache PROPERTIES  WORKING_DIRECTORY "/root/repo/bin/.." _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;17;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_unipy "/root/.pyenv/shims/python3" "test_uni.py")
+set_tests_properties(test_unipy PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;26;add_test;/root/repo/bin/CMakeLists.txt;0;")
+add_test(test_classgen_py "/root/.pyenv/shims/python3" "/root/repo/bin/../test/classgen_fixture.py" "--check")
+set_tests_properties(test_classgen_py PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/bin/CMakeLists.txt;27;add_test;/root/repo/bin/CMakeLists.txt;0;")
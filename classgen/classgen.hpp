@@ -22,6 +22,7 @@
 #include <bit>
 #include <set>
 #include <stdexcept>
+#include <utility>
 
 namespace clgen {
 enum class LookupFlag : uint8 {
@@ -82,12 +83,70 @@ struct ClassDataHeader {
   const ClassDataHeader *operator->() const { return this; }
 };
 
+// Run of count continuous size sized items at offset within record
+struct SwapPlanItem {
+  uint16 offset;
+  uint16 count;
+  uint8 size;
+};
+
+// Generated for every layout, items are ordered by offset
+template <size_t N> struct SwapPlan {
+  std::array<SwapPlanItem, N> items;
+};
+
+// Swaps numRecords records, stride bytes apart
+using SwapPlanFunc = void (*)(char *data, size_t numRecords, size_t stride);
+
+template <size_t offset, size_t count, size_t size>
+void SwapPlanRun(char *data) {
+  using type = typename es::TypeFromSize<size>::type;
+  type *items = reinterpret_cast<type *>(data + offset);
+
+  if constexpr (count * size >= 16) {
+    FArraySwapper(items, count);
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      FByteswapper(items[i]);
+    }
+  }
+}
+
+template <const auto &PLAN>
+void PlannedSwap(char *data, size_t numRecords, size_t stride) {
+  constexpr auto &items = PLAN.items;
+
+  // Record made of single type, all records are one continuous array
+  if constexpr (items.size() == 1 && items[0].offset == 0) {
+    if (items[0].count * items[0].size == stride) {
+      using type = typename es::TypeFromSize<items[0].size>::type;
+      FArraySwapper(reinterpret_cast<type *>(data),
+                    numRecords * items[0].count);
+      return;
+    }
+  }
+
+  for (size_t r = 0; r < numRecords; r++, data += stride) {
+    [data]<size_t... I>(std::index_sequence<I...>) {
+      (SwapPlanRun<items[I].offset, items[I].count, items[I].size>(data), ...);
+    }
+    (std::make_index_sequence<items.size()>{});
+  }
+}
+
 template <size_t N> struct ClassData : ClassDataHeader {
   std::array<int16, N> vtable;
   std::array<uint16, (N / 8) + (N % 8 ? 1 : 0)> swaps;
+  // Optional, generated PlannedSwap of this layout
+  SwapPlanFunc swapPlan = nullptr;
 };
 
 template <class IType> void EndianSwap(IType &interface) {
+  if (interface.layout->swapPlan) {
+    interface.layout->swapPlan(interface.data, 1, interface.layout->totalSize);
+    return;
+  }
+
   size_t numItems = interface.layout->vtable.size();
 
   for (size_t i = 0; i < numItems; ++i) {
@@ -124,6 +183,22 @@ template <class IType> void EndianSwap(IType &interface) {
   }
 }
 
+// Swaps numRecords continuous records, beginning with interface
+template <class IType> void EndianSwap(IType &interface, size_t numRecords) {
+  if (interface.layout->swapPlan) {
+    interface.layout->swapPlan(interface.data, numRecords,
+                               interface.layout->totalSize);
+    return;
+  }
+
+  IType item = interface;
+
+  for (size_t r = 0; r < numRecords; r++) {
+    EndianSwap(item);
+    item.data += item.layout->totalSize;
+  }
+}
+
 template <size_t N>
 auto GetLayout(const std::set<ClassData<N>> &layouts, LayoutLookup layout) {
   auto item = std::find_if(layouts.begin(), layouts.end(),
@@ -252,6 +252,7 @@ class LayoutItem:
         self.total_size = args[4]
         self.offsets = args[5]
         self.swaps = args[6]
+        self.swap_plan = None
 
     def __eq__(self, other):
         same_size = self.total_size == other.total_size
@@ -259,9 +260,32 @@ class LayoutItem:
         same_swaps = self.swaps == other.swaps
         return same_size and same_offsets and same_swaps
 
+    def gen_swap_plan(self):
+        # Runs of same sized swaps as [offset, count, size], ordered by offset
+        sizes = {SwapType.S16: 2, SwapType.S32: 4, SwapType.S64: 8}
+        items = sorted((o, sizes[s]) for o, s in zip(
+            self.offsets, self.swaps) if o >= 0 and s != SwapType.DontSwap)
+        runs = []
+
+        for offset, size in items:
+            if len(runs):
+                last = runs[-1]
+                if last[2] == size and last[0] + last[1] * size == offset:
+                    last[1] = last[1] + 1
+                    continue
+            runs.append([offset, 1, size])
+
+        return runs
+
+    def str_swap_plan_cpp(self):
+        runs = self.gen_swap_plan()
+        return 'static constexpr SwapPlan<%d> %s{{{%s}}};' % \
+            (len(runs), self.swap_plan, ', '.join('{%d, %d, %d}' % tuple(r) for r in runs))
+
     def str_cpp(self):
-        return '{{{{%s, %s, %s, %s}}, %s}, {%s}, {%s}}' % \
-            (self.version_begin, self.version_end, self.ptr_size, self.gnu_layout, self.total_size, str(self.offsets)[1:-1],  str(self.swaps)[1:-1].replace('\'', ''))
+        plan = ', PlannedSwap<%s>' % self.swap_plan if self.swap_plan else ''
+        return '{{{{%s, %s, %s, %s}}, %s}, {%s}, {%s}%s}' % \
+            (self.version_begin, self.version_end, self.ptr_size, self.gnu_layout, self.total_size, str(self.offsets)[1:-1],  str(self.swaps)[1:-1].replace('\'', ''), plan)
 
 
 class ClassData:
@@ -531,7 +555,10 @@ class ClassData:
 
     def gen_table_cpp(self, settings):
         tbl = self.gen_offset_table(settings)
-        for t in tbl:
+        plans = []
+        for i, t in enumerate(tbl):
+            t.swap_plan = 'SWAP_PLAN_%d' % i
+            plans.append(t.str_swap_plan_cpp())
             swaps = t.swaps
             nswaps = []
             cswap = 0
@@ -545,7 +572,7 @@ class ClassData:
                 nswaps.append(hex(cswap))
             t.swaps = nswaps
         hdr = 'static const std::set<ClassData<_count_>> LAYOUTS {\n  '
-        return hdr + ',\n  '.join(s.str_cpp() for s in tbl) + '\n};'
+        return '\n'.join(plans) + '\n' + hdr + ',\n  '.join(s.str_cpp() for s in tbl) + '\n};'
 
     def get_location(self, cur_offset, settings: PermSettings):
         inherits, members = self.collect_members(
@@ -21,6 +21,7 @@
 #include "datas/supercore.hpp"
 #include <functional>
 #include <iosfwd>
+#include <memory>
 #include <string>
 
 #ifdef MAIN_APP
@@ -44,6 +45,7 @@ enum class ArchiveLoadType : uint8 {
 class ReflectorFriend;
 struct AppContextStream;
 struct AppContextFoundStream;
+struct AppExtractContext;
 
 struct ExtractConf {
   bool makeZIP = true;
@@ -67,7 +69,7 @@ protected:
 };
 
 struct AppInfo_s {
-  static constexpr uint32 CONTEXT_VERSION = 1;
+  static constexpr uint32 CONTEXT_VERSION = 3;
   uint32 contextVersion;
   AppMode_e mode;
   ArchiveLoadType arcLoadType;
@@ -89,6 +91,11 @@ struct AppContext {
   virtual void DisposeFile(std::istream *file) = 0;
   virtual AppContextFoundStream FindFile(const std::string &rootFolder,
                                          const std::string &pattern) = 0;
+  // CONVERT mode only, nullptr otherwise
+  // Output files are created relative to outFile's folder, either as loose
+  // files or within ZIP (spike --convert-zip)
+  // Context is owned by AppContext and is finalized after AppProcessFile
+  virtual AppExtractContext *ExtractContext() { return nullptr; }
 };
 
 struct AppContextStream {
@@ -137,6 +144,11 @@ struct AppContextFoundStream : AppContextStream {
       : AppContextStream(str, ctx_), workingFile(workFile) {}
 };
 
+// Keeps sent data alive, writer destroys it after data is written
+struct AppDataOwner {
+  virtual ~AppDataOwner() = default;
+};
+
 struct AppExtractContext {
   AppContext *ctx = nullptr;
   virtual ~AppExtractContext() = default;
@@ -145,6 +157,29 @@ struct AppExtractContext {
   virtual bool RequiresFolders() const = 0;
   virtual void AddFolderPath(const std::string &path) = 0;
   virtual void GenerateFolders() = 0;
+  // Buffers are written in order as continuous data of current file
+  // With owner, data might be written in background, buffers must stay
+  // unchanged until owner is destroyed
+  // Without owner, data is written before returning
+  virtual void
+  SendBuffers(const es::string_view *buffers, size_t numBuffers,
+              [[maybe_unused]] std::unique_ptr<AppDataOwner> owner = {}) {
+    for (size_t b = 0; b < numBuffers; b++) {
+      SendData(buffers[b]);
+    }
+  }
+
+  // Transfers ownership of data to writer
+  void SendOwnedData(std::string &&data) {
+    struct StringOwner : AppDataOwner {
+      std::string data;
+    };
+
+    auto owner = std::make_unique<StringOwner>();
+    owner->data = std::move(data);
+    es::string_view view(owner->data);
+    SendBuffers(&view, 1, std::move(owner));
+  }
 };
 
 // Every call is multi-threaded
@@ -165,6 +200,9 @@ struct AppHelpContext {
 };
 
 using request_chunk = std::function<std::string(size_t offset, size_t size)>;
+// Returned view is valid until AppExtractStatSpan returns
+using request_span =
+    std::function<es::string_view(size_t offset, size_t size)>;
 
 extern "C" {
 AppInfo_s AC_EXTERN *AppInitModule();
@@ -172,8 +210,14 @@ void AC_EXTERN AppAdditionalHelp(AppHelpContext *ctx, size_t indent);
 bool AC_EXTERN AppInitContext(const std::string &dataFolder);
 void AC_EXTERN AppProcessFile(std::istream &stream, AppContext *ctx);
 void AC_EXTERN AppExtractFile(std::istream &stream, AppExtractContext *ctx);
+// Optional, used instead of AppProcessFile/AppExtractFile when exported
+// data is whole input file (mapped), valid only during the call
+void AC_EXTERN AppProcessBuffer(es::string_view data, AppContext *ctx);
+void AC_EXTERN AppExtractBuffer(es::string_view data, AppExtractContext *ctx);
 // Returns total number of files within archive
 size_t AC_EXTERN AppExtractStat(request_chunk requester);
+// Optional, used instead of AppExtractStat when exported
+size_t AC_EXTERN AppExtractStatSpan(request_span requester);
 AppPackContext AC_EXTERN *AppNewArchive(const std::string &folder,
                                         const AppPackStats &stats);
 void AC_EXTERN AppFinishContext();
@@ -18,6 +18,303 @@
 #pragma once
 #include "binreader_stream.hpp"
 #include "binwritter_stream.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <emmintrin.h>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+// Memory kernels, 8 bytes of value are processed at once
+namespace es::varint {
+static constexpr size_t MAX_SIZE = 9;
+// Encoders store whole words, output must have this many bytes available
+static constexpr size_t ENCODE_SIZE = 16;
+
+// 8 groups of 7 bits -> 56 bit value
+inline uint64 Compact(uint64 groups) {
+#ifdef __BMI2__
+  return _pext_u64(groups, 0x7f7f7f7f7f7f7f7f);
+#else
+  uint64 x = groups & 0x7f7f7f7f7f7f7f7f;
+  x = ((x & 0x7f007f007f007f00) >> 1) | (x & 0x007f007f007f007f);
+  x = ((x & 0x3fff00003fff0000) >> 2) | (x & 0x00003fff00003fff);
+  return ((x & 0x0fffffff00000000) >> 4) | (x & 0x000000000fffffff);
+#endif
+}
+
+// 56 bit value -> 8 groups of 7 bits
+inline uint64 Spread(uint64 value) {
+#ifdef __BMI2__
+  return _pdep_u64(value, 0x7f7f7f7f7f7f7f7f);
+#else
+  uint64 x = value & 0x00ffffffffffffff;
+  x = ((x & 0x00fffffff0000000) << 4) | (x & 0x000000000fffffff);
+  x = ((x & 0x0fffc0000fffc000) << 2) | (x & 0x00003fff00003fff);
+  return ((x & 0x3f803f803f803f80) << 1) | (x & 0x007f007f007f007f);
+#endif
+}
+
+inline uint64 LoadWord(const char *data) {
+  uint64 word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+// Continuation flags of first numBytes - 1 bytes
+inline uint64 ContinuationMask(size_t numBytes) {
+  return (0x8080808080808080 >> (8 * (8 - numBytes))) >> 8;
+}
+
+// Returns number of decoded bytes, 0 if value is truncated
+inline size_t DecodeUnsigned(const char *data, size_t size, uint64 &value) {
+  if (size >= MAX_SIZE) {
+    const uint64 word = LoadWord(data);
+    const uint64 stops = ~word & 0x8080808080808080;
+
+    if (!stops) {
+      value = Compact(word) | uint64(uint8(data[8])) << 56;
+      return MAX_SIZE;
+    }
+
+    const size_t numBits = std::countr_zero(stops) + 1;
+    const uint64 mask = numBits == 64 ? ~uint64(0) : (uint64(1) << numBits) - 1;
+    value = Compact(word & mask);
+    return numBits / 8;
+  }
+
+  uint64 result = 0;
+
+  for (size_t id = 0; id < size; id++) {
+    const uint8 cNum = data[id];
+
+    if (id == 8) {
+      value = result | uint64(cNum) << 56;
+      return MAX_SIZE;
+    }
+
+    result |= uint64(cNum & 0x7f) << (7 * id);
+
+    if (!(cNum & 0x80)) {
+      value = result;
+      return id + 1;
+    }
+  }
+
+  return 0;
+}
+
+// Returns number of decoded bytes, 0 if value is truncated
+inline size_t DecodeSigned(const char *data, size_t size, int64 &value) {
+  if (size >= MAX_SIZE) {
+    const uint64 word = LoadWord(data);
+    const uint64 stops = ~word & 0x8080808080808080;
+
+    if (!stops) {
+      value = Compact(word) | uint64(uint8(data[8])) << 56;
+      return MAX_SIZE;
+    }
+
+    const size_t numBits = std::countr_zero(stops) + 1;
+    const uint64 mask = numBits == 64 ? ~uint64(0) : (uint64(1) << numBits) - 1;
+    const uint64 signBit = uint64(1) << (numBits - 2);
+    const uint64 result = Compact(word & mask & ~signBit);
+    value = result ^ -uint64((word & signBit) != 0);
+    return numBits / 8;
+  }
+
+  uint64 result = 0;
+
+  for (size_t id = 0; id < size; id++) {
+    const uint8 cNum = data[id];
+
+    if (id == 8) {
+      value = result | uint64(cNum) << 56;
+      return MAX_SIZE;
+    }
+
+    if (!(cNum & 0x80)) {
+      result |= uint64(cNum & 0x3f) << (7 * id);
+      value = cNum & 0x40 ? ~result : result;
+      return id + 1;
+    }
+
+    result |= uint64(cNum & 0x7f) << (7 * id);
+  }
+
+  return 0;
+}
+
+// Returns number of encoded bytes, ENCODE_SIZE bytes must be available
+inline size_t EncodeUnsigned(char *out, uint64 value) {
+  const size_t numBits = 64 - std::countl_zero(value | 1);
+  const size_t numBytes = (numBits + 6) / 7;
+
+  if (numBytes > 8) {
+    const uint64 word = Spread(value) | 0x8080808080808080;
+    memcpy(out, &word, sizeof(word));
+    out[8] = static_cast<char>(value >> 56);
+    return MAX_SIZE;
+  }
+
+  const uint64 word = Spread(value) | ContinuationMask(numBytes);
+  memcpy(out, &word, sizeof(word));
+  return numBytes;
+}
+
+// Returns number of encoded bytes, ENCODE_SIZE bytes must be available
+inline size_t EncodeSigned(char *out, int64 value) {
+  // there shouldn't be a sign flag for values lower than
+  // -36'028'797'018'963'968, sign flag doesn't fit into 9th byte
+  const bool sign = value < 0 && !(~(value >> 55));
+  const uint64 valueCopy = sign ? ~value : value;
+  const uint64 signMask = sign ? 0x40 : 0;
+  // Last byte holds only 6 bits, sign flag is 7th
+  const size_t numBits = 64 - std::countl_zero(valueCopy);
+  const size_t numBytes = numBits / 7 + 1;
+
+  if (numBytes > 8) {
+    const uint64 word = Spread(valueCopy) | 0x8080808080808080;
+    memcpy(out, &word, sizeof(word));
+    out[8] = static_cast<char>(valueCopy >> 56);
+    return MAX_SIZE;
+  }
+
+  const uint64 word = Spread(valueCopy) | ContinuationMask(numBytes) |
+                      signMask << (8 * (numBytes - 1));
+  memcpy(out, &word, sizeof(word));
+  return numBytes;
+}
+
+template <class C> using value_type = decltype(C::value);
+
+// Decodes up to numItems of bint128/buint128 from memory
+// Runs of single byte values are decoded in groups of 16
+// Returns number of decoded bytes, numItems is set to number of decoded items
+template <class C>
+size_t Decode(const char *data, size_t size, C *items, size_t &numItems) {
+  constexpr bool isSigned = std::is_signed_v<value_type<C>>;
+  size_t numDecoded = 0;
+  size_t pos = 0;
+
+  while (numDecoded < numItems) {
+    if (size - pos >= 16) {
+      const __m128i group =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+      const uint32 flags = _mm_movemask_epi8(group);
+      const size_t numSingles =
+          std::min<size_t>(std::countr_zero(flags | 0x10000),
+                           numItems - numDecoded);
+
+      for (size_t i = 0; i < numSingles; i++) {
+        const uint8 cNum = data[pos + i];
+
+        if constexpr (isSigned) {
+          items[numDecoded + i].value =
+              int64(cNum & 0x3f) ^ -int64((cNum & 0x40) != 0);
+        } else {
+          items[numDecoded + i].value = cNum;
+        }
+      }
+
+      pos += numSingles;
+      numDecoded += numSingles;
+
+      if (numSingles == 16 || numDecoded == numItems) {
+        continue;
+      }
+    }
+
+    value_type<C> value;
+    size_t numBytes;
+
+    if constexpr (isSigned) {
+      numBytes = DecodeSigned(data + pos, size - pos, value);
+    } else {
+      numBytes = DecodeUnsigned(data + pos, size - pos, value);
+    }
+
+    if (!numBytes) {
+      break;
+    }
+
+    items[numDecoded++].value = value;
+    pos += numBytes;
+  }
+
+  numItems = numDecoded;
+  return pos;
+}
+
+// Output must have numItems * MAX_SIZE + ENCODE_SIZE bytes available
+// Returns number of encoded bytes
+template <class C> size_t Encode(char *out, const C *items, size_t numItems) {
+  char *cOut = out;
+
+  for (size_t i = 0; i < numItems; i++) {
+    if constexpr (std::is_signed_v<value_type<C>>) {
+      cOut += EncodeSigned(cOut, items[i].value);
+    } else {
+      cOut += EncodeUnsigned(cOut, items[i].value);
+    }
+  }
+
+  return cOut - out;
+}
+
+template <class reader, class C>
+void ReadItems(reader rd, C *items, size_t numItems) {
+  // Memory span, decode in place
+  if constexpr (requires { rd.Remaining(); }) {
+    const auto data = rd.Remaining();
+    const size_t numRequested = numItems;
+    rd.Skip(Decode(data.data(), data.size(), items, numItems));
+
+    if (numItems != numRequested) {
+      throw std::runtime_error("Truncated base 128 data");
+    }
+  } else {
+    // Read in chunks, unused tail of chunk is returned into stream
+    constexpr size_t CHUNK_SIZE = 0x1000;
+    char buffer[CHUNK_SIZE];
+    size_t available = rd.GetSize() - rd.Tell();
+
+    while (numItems) {
+      const size_t chunkSize =
+          std::min({available, numItems * MAX_SIZE, CHUNK_SIZE});
+      size_t numDecoded = numItems;
+      rd.ReadBuffer(buffer, chunkSize);
+      const size_t numBytes = Decode(buffer, chunkSize, items, numDecoded);
+
+      if (!numDecoded) {
+        throw std::runtime_error("Truncated base 128 data");
+      }
+
+      rd.Skip(int64(numBytes) - int64(chunkSize));
+      available -= numBytes;
+      items += numDecoded;
+      numItems -= numDecoded;
+    }
+  }
+}
+
+template <class writer, class C>
+void WriteItems(writer wr, const C *items, size_t numItems) {
+  constexpr size_t CHUNK_ITEMS = 0x100;
+  char buffer[CHUNK_ITEMS * MAX_SIZE + ENCODE_SIZE];
+
+  while (numItems) {
+    const size_t numChunkItems = std::min(numItems, CHUNK_ITEMS);
+    wr.WriteBuffer(buffer, Encode(buffer, items, numChunkItems));
+    items += numChunkItems;
+    numItems -= numChunkItems;
+  }
+}
+} // namespace es::varint
 
 struct bint128 {
   int64 value;
@@ -27,7 +324,20 @@ struct bint128 {
 
   operator int64() const { return value; }
 
-  int64 Read(BinReaderRef rd) {
+  template <class reader> int64 Read(reader rd) {
+    if constexpr (requires { rd.Remaining(); }) {
+      const auto data = rd.Remaining();
+      const size_t numBytes =
+          es::varint::DecodeSigned(data.data(), data.size(), value);
+
+      if (!numBytes) {
+        throw std::runtime_error("Truncated base 128 data");
+      }
+
+      rd.Skip(numBytes);
+      return value;
+    }
+
     value = 0;
     for (size_t id = 0; id < 9; id++) {
       uint8 cNum;
@@ -52,37 +362,20 @@ struct bint128 {
     return value;
   }
 
-  void Write(BinWritterRef wr) const {
-    // there shouldn't be a sign flag for values lower than
-    // -72'057'594'037'927'936
-    bool sign = value < 0 && !(~(value >> 56));
-    uint64 valueCopy = sign ? ~value : value;
-    uint8 lastValue = 0;
-    size_t lastIndex = 0;
-
-    while (true) {
-      lastValue = static_cast<uint8>(valueCopy);
-      valueCopy >>= 7;
-
-      if (!valueCopy) {
-        break;
-      }
+  template <class writer> void Write(writer wr) const {
+    char buffer[es::varint::ENCODE_SIZE];
+    wr.WriteBuffer(buffer, es::varint::EncodeSigned(buffer, value));
+  }
 
-      wr.Write<uint8>(lastValue | 0x80);
-      lastIndex++;
-    }
+  // Used by ReadContainer and WriteContainer
+  template <class reader>
+  static void ReadBulk(reader rd, bint128 *items, size_t numItems) {
+    es::varint::ReadItems(rd, items, numItems);
+  }
 
-    if (lastIndex < 8) {
-      auto signMask = sign ? 0x40 : 0;
-      if (lastValue & 0x40) {
-        wr.Write<uint8>(lastValue | 0x80);
-        wr.Write<uint8>(signMask);
-      } else {
-        wr.Write<uint8>(lastValue | signMask);
-      }
-    } else {
-      wr.Write(lastValue);
-    }
+  template <class writer>
+  static void WriteBulk(writer wr, const bint128 *items, size_t numItems) {
+    es::varint::WriteItems(wr, items, numItems);
   }
 };
 
@@ -94,7 +387,20 @@ struct buint128 {
 
   operator uint64() const { return value; }
 
-  uint64 Read(BinReaderRef rd) {
+  template <class reader> uint64 Read(reader rd) {
+    if constexpr (requires { rd.Remaining(); }) {
+      const auto data = rd.Remaining();
+      const size_t numBytes =
+          es::varint::DecodeUnsigned(data.data(), data.size(), value);
+
+      if (!numBytes) {
+        throw std::runtime_error("Truncated base 128 data");
+      }
+
+      rd.Skip(numBytes);
+      return value;
+    }
+
     value = 0;
     for (size_t id = 0; id < 9; id++) {
       uint8 cNum;
@@ -114,22 +420,19 @@ struct buint128 {
     return value;
   }
 
-  void Write(BinWritterRef wr) const {
-    uint64 valueCopy = value;
-    size_t index = 0;
-
-    while (true) {
-      const auto lastValue = static_cast<uint8>(valueCopy);
-      valueCopy >>= 7;
+  template <class writer> void Write(writer wr) const {
+    char buffer[es::varint::ENCODE_SIZE];
+    wr.WriteBuffer(buffer, es::varint::EncodeUnsigned(buffer, value));
+  }
 
-      if (!valueCopy || index == 8) {
-        wr.Write(lastValue);
-        break;
-      } else {
-        wr.Write<uint8>(lastValue | 0x80);
-      }
+  // Used by ReadContainer and WriteContainer
+  template <class reader>
+  static void ReadBulk(reader rd, buint128 *items, size_t numItems) {
+    es::varint::ReadItems(rd, items, numItems);
+  }
 
-      index++;
-    }
+  template <class writer>
+  static void WriteBulk(writer wr, const buint128 *items, size_t numItems) {
+    es::varint::WriteItems(wr, items, numItems);
   }
 };
@@ -25,6 +25,9 @@ enum class BinCoreOpenMode {
   Truncate = 8,
   NoBuffer = 0x10,
   Out = 0x20, // internal use only
+  Mapped = 0x40, // BinReader only, file is mapped into memory
+  Sequential = 0x80, // Mapped access hint, random access otherwise
+  ReadAhead = 0x100, // BinReader only, next block is read in background
 };
 
 constexpr BinCoreOpenMode operator|(BinCoreOpenMode o1, BinCoreOpenMode o2) {
@@ -42,6 +45,12 @@ class BinStreamInTraits;
 template <class _Traits, bool HandleEndian> class BinReaderRef_t;
 using BinReaderRef_e = BinReaderRef_t<BinStreamInTraits, true>;
 typedef BinReaderRef_t<BinStreamInTraits, false> BinReaderRef;
+// Drop-in replacement for BinReaderRef(_e) over memory span
+// Types with Read(BinReaderRef) member must take reader as template argument
+class BinSpanInTraits;
+class BinReaderSpan;
+using BinReaderSpanRef_e = BinReaderRef_t<BinSpanInTraits, true>;
+using BinReaderSpanRef = BinReaderRef_t<BinSpanInTraits, false>;
 
 template <BinCoreOpenMode MODE = BinCoreOpenMode::Default> class BinWritter_t;
 using BinWritter = BinWritter_t<>;
@@ -49,3 +58,8 @@ class BinStreamOutTraits;
 template <class _Traits, bool HandleEndian> class BinWritterRef_t;
 using BinWritterRef_e = BinWritterRef_t<BinStreamOutTraits, true>;
 typedef BinWritterRef_t<BinStreamOutTraits, false> BinWritterRef;
+// Writer with large owned buffer, see binwritter_buffered.hpp
+class BinBufferOutTraits;
+class BinWritterBuffered;
+using BinWritterBufferedRef_e = BinWritterRef_t<BinBufferOutTraits, true>;
+using BinWritterBufferedRef = BinWritterRef_t<BinBufferOutTraits, false>;
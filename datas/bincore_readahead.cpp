@@ -0,0 +1,216 @@
+/*  source for asynchronous read-ahead stream
+
+    Copyright 2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "internal/bincore_readahead.hpp"
+#include <algorithm>
+
+#if defined(_MSC_VER) || defined(__MINGW64__)
+#include "unicode.hpp"
+#include <fcntl.h>
+#include <io.h>
+
+static int OpenFile(const std::string &path) {
+  return _wopen(es::ToUTF1632(path).c_str(), _O_RDONLY | _O_BINARY);
+}
+
+static void CloseFile(int64 fd) { _close(fd); }
+
+static size_t FileSize(int64 fd) { return _lseeki64(fd, 0, SEEK_END); }
+
+// Only worker thread reads, so seek + read is fine
+static size_t ReadFile(int64 fd, size_t offset, char *data, size_t size) {
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+    return 0;
+  }
+
+  size_t numRead = 0;
+
+  while (numRead < size) {
+    const unsigned chunk = std::min(size - numRead, size_t(0x40000000));
+    const int result = _read(fd, data + numRead, chunk);
+
+    if (result <= 0) {
+      break;
+    }
+
+    numRead += result;
+  }
+
+  return numRead;
+}
+#else
+#include <fcntl.h>
+#include <unistd.h>
+
+static int OpenFile(const std::string &path) {
+  return open(path.c_str(), O_RDONLY);
+}
+
+static void CloseFile(int64 fd) { close(fd); }
+
+static size_t FileSize(int64 fd) { return lseek(fd, 0, SEEK_END); }
+
+static size_t ReadFile(int64 fd, size_t offset, char *data, size_t size) {
+  size_t numRead = 0;
+
+  while (numRead < size) {
+    const ssize_t result =
+        pread(fd, data + numRead, size - numRead, offset + numRead);
+
+    if (result <= 0) {
+      break;
+    }
+
+    numRead += result;
+  }
+
+  return numRead;
+}
+#endif
+
+ReadAheadStreamBuf::ReadAheadStreamBuf(const std::string &path,
+                                       size_t blockSize_)
+    : front(new char[blockSize_]), back(new char[blockSize_]),
+      blockSize(blockSize_), fd(OpenFile(path)) {
+  if (fd < 0) {
+    throw es::FileNotFoundError(path);
+  }
+
+  fileSize = FileSize(fd);
+  setg(front.get(), front.get(), front.get());
+  worker = std::thread(&ReadAheadStreamBuf::Worker, this);
+  Request(0);
+}
+
+ReadAheadStreamBuf::~ReadAheadStreamBuf() {
+  {
+    std::lock_guard<std::mutex> lg(mtx);
+    quit = true;
+  }
+
+  signal.notify_all();
+  worker.join();
+  CloseFile(fd);
+}
+
+void ReadAheadStreamBuf::Worker() {
+  std::unique_lock<std::mutex> lk(mtx);
+
+  while (true) {
+    signal.wait(lk, [&] { return pending || quit; });
+
+    if (quit) {
+      return;
+    }
+
+    const size_t offset = backOffset;
+    char *data = back.get();
+    const size_t size =
+        offset < fileSize ? std::min(blockSize, fileSize - offset) : 0;
+
+    lk.unlock();
+    const size_t numRead = ReadFile(fd, offset, data, size);
+    lk.lock();
+
+    backSize = numRead;
+    pending = false;
+    signal.notify_all();
+  }
+}
+
+void ReadAheadStreamBuf::Request(size_t offset) {
+  {
+    std::lock_guard<std::mutex> lg(mtx);
+    backOffset = offset;
+    backSize = 0;
+    pending = true;
+  }
+
+  signal.notify_all();
+}
+
+void ReadAheadStreamBuf::Wait() {
+  std::unique_lock<std::mutex> lk(mtx);
+  signal.wait(lk, [&] { return !pending; });
+}
+
+ReadAheadStreamBuf::int_type ReadAheadStreamBuf::underflow() {
+  const size_t next = frontOffset + (gptr() - eback());
+
+  if (next >= fileSize) {
+    return traits_type::eof();
+  }
+
+  Wait();
+
+  // Seeked outside of prefetched block
+  if (!InBack(next)) {
+    Request(next);
+    Wait();
+
+    if (!InBack(next)) {
+      return traits_type::eof();
+    }
+  }
+
+  std::swap(front, back);
+  frontOffset = backOffset;
+  setg(front.get(), front.get() + (next - frontOffset),
+       front.get() + backSize);
+
+  if (const size_t nextBlock = frontOffset + backSize; nextBlock < fileSize) {
+    Request(nextBlock);
+  } else {
+    // Back holds previous front now, it must not be found by InBack
+    std::lock_guard<std::mutex> lg(mtx);
+    backSize = 0;
+  }
+
+  return traits_type::to_int_type(*gptr());
+}
+
+ReadAheadStreamBuf::pos_type
+ReadAheadStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                            std::ios_base::openmode which) {
+  if (!(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+
+  const size_t frontSize = egptr() - eback();
+  const off_type base = dir == std::ios_base::beg ? 0
+                        : dir == std::ios_base::cur
+                            ? off_type(frontOffset + (gptr() - eback()))
+                            : off_type(fileSize);
+  const off_type target = base + off;
+
+  if (target < 0 || size_t(target) > fileSize) {
+    return pos_type(off_type(-1));
+  }
+
+  if (size_t(target) >= frontOffset &&
+      size_t(target) <= frontOffset + frontSize) {
+    setg(eback(), eback() + (target - frontOffset), egptr());
+    return pos_type(target);
+  }
+
+  // Get area is dropped, underflow continues from target
+  // and uses back block if it's already there
+  frontOffset = target;
+  setg(front.get(), front.get(), front.get());
+
+  return pos_type(target);
+}
@@ -19,10 +19,22 @@
 #include "binreader_stream.hpp"
 #include "except.hpp"
 #include "internal/bincore_file.hpp"
+#include "internal/bincore_mapped.hpp"
+#include "internal/bincore_readahead.hpp"
+#include <type_traits>
 
+// With BinCoreOpenMode::Mapped, BaseStream reads directly from mapped file
+// With BinCoreOpenMode::ReadAhead, BaseStream is double buffered and next
+// block is read by background thread, block size is set by BlockSize
 template <BinCoreOpenMode MODE>
-class BinReader_t : public BinStreamFile<MODE>, public BinReaderRef {
-  using base_file = BinStreamFile<MODE>;
+using BinReaderFile_t = std::conditional_t<
+    MODE & BinCoreOpenMode::Mapped, BinStreamMapped<MODE>,
+    std::conditional_t<MODE & BinCoreOpenMode::ReadAhead,
+                       BinStreamReadAhead<MODE>, BinStreamFile<MODE>>>;
+
+template <BinCoreOpenMode MODE>
+class BinReader_t : public BinReaderFile_t<MODE>, public BinReaderRef {
+  using base_file = BinReaderFile_t<MODE>;
   template <class C> void OpenFile(const C fileName) {
     if (!this->Open_(fileName)) {
       throw es::FileNotFoundError(fileName);
@@ -50,7 +50,9 @@ public:
       return;
     }
 
-    if constexpr (use_read_v<T>) {
+    if constexpr (use_read_bulk_v<T>) {
+      T::ReadBulk(*this, &input[0], numitems);
+    } else if constexpr (use_read_v<T>) {
       for (auto &item : input) {
         item.Read(*this);
       }
@@ -60,9 +62,7 @@ public:
 
       if constexpr (HandleEndian && size > 1) {
         if (this->swapEndian) {
-          for (auto &item : input) {
-            FByteswapper(item);
-          }
+          FArraySwapper(&input[0], numitems);
         }
       }
     }
@@ -157,6 +157,12 @@ private:
   using use_read = decltype(std::declval<T>().Read(std::declval<Self>()));
   template <class C>
   constexpr static bool use_read_v = es::is_detected_v<use_read, C>;
+  // Optional static ReadBulk(reader, T *items, size_t numItems) for containers
+  template <class T>
+  using use_read_bulk = decltype(T::ReadBulk(
+      std::declval<Self>(), std::declval<T *>(), size_t{}));
+  template <class C>
+  constexpr static bool use_read_bulk_v = es::is_detected_v<use_read_bulk, C>;
   template <class T> using no_swap = decltype(std::declval<T>().NoSwap());
   template <class C>
   constexpr static bool use_swap_v = !es::is_detected_v<no_swap, C>;
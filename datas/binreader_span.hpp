@@ -0,0 +1,112 @@
+/*  traits class for reading data from memory span
+
+    Copyright 2018-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "binreader_ref.hpp"
+#include "string_view.hpp"
+#include <cstring>
+#include <stdexcept>
+
+// Memory range with read position, shared by all copies of reader
+struct BinSpanStream {
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  const char *current = nullptr;
+
+  BinSpanStream() = default;
+  BinSpanStream(es::string_view span)
+      : begin(span.data()), end(span.data() + span.size()), current(begin) {}
+};
+
+// Reads from [begin, end) memory range without any stream involved
+// Out of range access throws only in debug builds
+class BinSpanInTraits : public BinSteamEndian {
+public:
+  typedef BinSpanStream StreamType;
+  typedef std::ios_base::seekdir seekdir;
+  static const auto beg = std::ios_base::beg;
+  static const auto cur = std::ios_base::cur;
+  static const auto end = std::ios_base::end;
+
+protected:
+  StreamType *baseStream;
+  BinSpanInTraits() noexcept : baseStream(nullptr) {}
+  BinSpanInTraits(StreamType &stream) noexcept : baseStream(&stream) {}
+
+  void CheckRange([[maybe_unused]] const char *newPos) const {
+#ifndef NDEBUG
+    if (newPos < baseStream->begin || newPos > baseStream->end) {
+      throw std::out_of_range("BinReaderSpan access out of range");
+    }
+#endif
+  }
+
+public:
+  size_t Tell() const { return baseStream->current - baseStream->begin; }
+
+  void Seek(size_t position,
+            std::ios_base::seekdir vay = std::ios_base::beg) const {
+    const char *base = vay == beg   ? baseStream->begin
+                       : vay == cur ? baseStream->current
+                                    : baseStream->end;
+    CheckRange(base + position);
+    baseStream->current = base + position;
+  }
+
+  void Skip(int64 length) const {
+    CheckRange(baseStream->current + length);
+    baseStream->current += length;
+  }
+
+  void Read(char *buffer, size_t size) const {
+    CheckRange(baseStream->current + size);
+    memcpy(buffer, baseStream->current, size);
+    baseStream->current += size;
+  }
+
+  bool IsEOF() const { return baseStream->current >= baseStream->end; }
+
+  StreamType &BaseStream() { return *baseStream; }
+
+  // Remaining data, can be used for zero copy access
+  es::string_view Remaining() const {
+    return {baseStream->current,
+            size_t(baseStream->end - baseStream->current)};
+  }
+};
+
+// Owns read position of span, span data must outlive reader
+class BinReaderSpan : public BinReaderSpanRef {
+  BinSpanStream span;
+
+public:
+  BinReaderSpan() = default;
+  BinReaderSpan(es::string_view data) : span(data) {
+    this->baseStream = &span;
+  }
+  BinReaderSpan(const BinReaderSpan &) = delete;
+  BinReaderSpan(BinReaderSpan &&o) : BinReaderSpanRef(o), span(o.span) {
+    this->baseStream = &span;
+  }
+  BinReaderSpan &operator=(const BinReaderSpan &) = delete;
+  BinReaderSpan &operator=(BinReaderSpan &&o) {
+    static_cast<BinReaderSpanRef &>(*this) = o;
+    span = o.span;
+    this->baseStream = &span;
+    return *this;
+  }
+};
@@ -0,0 +1,183 @@
+/*  source for buffered binary writter
+
+    Copyright 2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "binwritter_buffered.hpp"
+#include "except.hpp"
+
+#if defined(_MSC_VER) || defined(__MINGW64__)
+#include "unicode.hpp"
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+
+static int OpenFile(const std::string &path) {
+  return _wopen(es::ToUTF1632(path).c_str(),
+                _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                _S_IREAD | _S_IWRITE);
+}
+
+static void CloseFile(int64 fd) { _close(fd); }
+
+// No positional vectored write, every buffer is written separately
+static bool WriteFile(int64 fd, size_t offset, const char *const *data,
+                      const size_t *sizes, size_t numBuffers) {
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+    return false;
+  }
+
+  for (size_t b = 0; b < numBuffers; b++) {
+    const char *cData = data[b];
+    size_t remaining = sizes[b];
+
+    while (remaining) {
+      const unsigned chunk = std::min(remaining, size_t(0x40000000));
+      const int written = _write(fd, cData, chunk);
+
+      if (written <= 0) {
+        return false;
+      }
+
+      cData += written;
+      remaining -= written;
+    }
+  }
+
+  return true;
+}
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static int OpenFile(const std::string &path) {
+  return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+}
+
+static void CloseFile(int64 fd) { close(fd); }
+
+static bool WriteFile(int64 fd, size_t offset, const char *const *data,
+                      const size_t *sizes, size_t numBuffers) {
+  iovec vecs[2];
+
+  for (size_t b = 0; b < numBuffers; b++) {
+    vecs[b].iov_base = const_cast<char *>(data[b]);
+    vecs[b].iov_len = sizes[b];
+  }
+
+  iovec *cVec = vecs;
+  size_t numVecs = numBuffers;
+
+  while (numVecs) {
+    const ssize_t written = pwritev(fd, cVec, numVecs, offset);
+
+    if (written <= 0) {
+      return false;
+    }
+
+    offset += written;
+    size_t remaining = written;
+
+    // Partial write, continue from unwritten part
+    while (numVecs && remaining >= cVec->iov_len) {
+      remaining -= cVec->iov_len;
+      cVec++;
+      numVecs--;
+    }
+
+    if (numVecs) {
+      cVec->iov_base = static_cast<char *>(cVec->iov_base) + remaining;
+      cVec->iov_len -= remaining;
+    }
+  }
+
+  return true;
+}
+#endif
+
+BinBufferStream::BinBufferStream(const std::string &path, size_t bufferSize_)
+    : buffer(new char[bufferSize_]), bufferSize(bufferSize_),
+      fd(OpenFile(path)) {
+  if (fd < 0) {
+    throw es::FileInvalidAccessError(path);
+  }
+}
+
+BinBufferStream::~BinBufferStream() {
+  try {
+    Close();
+  } catch (...) {
+  }
+}
+
+void BinBufferStream::Flush() {
+  if (bufferEnd) {
+    const char *data = buffer.get();
+
+    if (!WriteFile(fd, fileOffset, &data, &bufferEnd, 1)) {
+      throw std::runtime_error("Cannot write into file.");
+    }
+  }
+
+  fileSize = Size();
+  fileOffset += bufferPos;
+  bufferPos = 0;
+  bufferEnd = 0;
+}
+
+void BinBufferStream::Close() {
+  if (fd < 0) {
+    return;
+  }
+
+  Flush();
+  CloseFile(fd);
+  fd = -1;
+}
+
+void BinBufferStream::WriteThrough(const char *data, size_t size) {
+  // Appending, buffer and data are continuous
+  if (bufferPos == bufferEnd) {
+    const char *datas[]{buffer.get(), data};
+    const size_t sizes[]{bufferEnd, size};
+
+    if (!WriteFile(fd, fileOffset, datas, sizes, 2)) {
+      throw std::runtime_error("Cannot write into file.");
+    }
+
+    fileOffset += bufferEnd + size;
+    fileSize = std::max(fileSize, fileOffset);
+    bufferPos = 0;
+    bufferEnd = 0;
+    return;
+  }
+
+  Flush();
+
+  if (size <= bufferSize) {
+    Write(data, size);
+  } else if (!WriteFile(fd, fileOffset, &data, &size, 1)) {
+    throw std::runtime_error("Cannot write into file.");
+  } else {
+    fileOffset += size;
+    fileSize = std::max(fileSize, fileOffset);
+  }
+}
+
+void BinBufferStream::SeekFile(size_t position) {
+  Flush();
+  fileOffset = position;
+}
@@ -0,0 +1,166 @@
+/*  traits class for writing data through owned buffer
+
+    Copyright 2018-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "binwritter_ref.hpp"
+#include "settings.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// File with write buffer, shared by all copies of writer
+// Buffer holds file data of [fileOffset, fileOffset + bufferEnd)
+struct BinBufferStream {
+  static constexpr size_t DEFAULT_SIZE = 0x100000;
+
+  std::unique_ptr<char[]> buffer;
+  size_t bufferSize = 0;
+  size_t bufferPos = 0;
+  size_t bufferEnd = 0;
+  size_t fileOffset = 0;
+  size_t fileSize = 0;
+  int64 fd = -1;
+
+  BinBufferStream() = default;
+  PC_EXTERN BinBufferStream(const std::string &path,
+                            size_t bufferSize_ = DEFAULT_SIZE);
+  BinBufferStream(const BinBufferStream &) = delete;
+  BinBufferStream(BinBufferStream &&other) { *this = std::move(other); }
+  BinBufferStream &operator=(const BinBufferStream &) = delete;
+  BinBufferStream &operator=(BinBufferStream &&other) {
+    std::swap(buffer, other.buffer);
+    std::swap(bufferSize, other.bufferSize);
+    std::swap(bufferPos, other.bufferPos);
+    std::swap(bufferEnd, other.bufferEnd);
+    std::swap(fileOffset, other.fileOffset);
+    std::swap(fileSize, other.fileSize);
+    std::swap(fd, other.fd);
+    return *this;
+  }
+  // Flush errors are lost, call Close to handle them
+  PC_EXTERN ~BinBufferStream();
+
+  PC_EXTERN void Flush();
+  PC_EXTERN void Close();
+  // Called when data doesn't fit into buffer, appended data is written
+  // together with buffer by single vectored write
+  PC_EXTERN void WriteThrough(const char *data, size_t size);
+  // Outside of buffered data
+  PC_EXTERN void SeekFile(size_t position);
+
+  size_t Tell() const { return fileOffset + bufferPos; }
+  size_t Size() const { return std::max(fileSize, fileOffset + bufferEnd); }
+
+  void Write(const char *data, size_t size) {
+    if (bufferPos + size > bufferSize) {
+      WriteThrough(data, size);
+      return;
+    }
+
+    memcpy(buffer.get() + bufferPos, data, size);
+    bufferPos += size;
+    bufferEnd = std::max(bufferEnd, bufferPos);
+  }
+
+  // Back-patching within buffered data doesn't touch file
+  void Seek(size_t position) {
+    if (position >= fileOffset && position <= fileOffset + bufferEnd) {
+      bufferPos = position - fileOffset;
+    } else {
+      SeekFile(position);
+    }
+  }
+};
+
+class BinBufferOutTraits : public BinSteamEndian {
+public:
+  typedef BinBufferStream StreamType;
+  typedef std::ios_base::seekdir seekdir;
+  static const auto beg = std::ios_base::beg;
+  static const auto cur = std::ios_base::cur;
+  static const auto end = std::ios_base::end;
+
+protected:
+  StreamType *baseStream;
+  BinBufferOutTraits() noexcept : baseStream(nullptr) {}
+  BinBufferOutTraits(StreamType &stream) noexcept : baseStream(&stream) {}
+
+public:
+  size_t Tell() const { return baseStream->Tell(); }
+
+  void Seek(size_t position,
+            std::ios_base::seekdir vay = std::ios_base::beg) const {
+    if (vay == cur) {
+      position += baseStream->Tell();
+    } else if (vay == end) {
+      position += baseStream->Size();
+    }
+
+    baseStream->Seek(position);
+  }
+
+  void Skip(int64 length) const {
+    if (length > 0) {
+      static constexpr char FILLBUFFER[32] = {};
+      const size_t numLoops = length / 32;
+
+      for (size_t t = 0; t < numLoops; t++) {
+        Write(FILLBUFFER, 32);
+      }
+
+      Write(FILLBUFFER, length % 32);
+    } else {
+      Seek(Tell() + length);
+    }
+  }
+
+  void Write(const char *buffer, size_t size) const {
+    baseStream->Write(buffer, size);
+  }
+
+  bool IsEOF() const { return false; }
+
+  StreamType &BaseStream() { return *baseStream; }
+};
+
+// Owns buffered file, data is flushed on Close or destruction
+class BinWritterBuffered : public BinWritterBufferedRef {
+  BinBufferStream stream;
+
+public:
+  BinWritterBuffered() = default;
+  BinWritterBuffered(const std::string &filePath,
+                     size_t bufferSize = BinBufferStream::DEFAULT_SIZE)
+      : stream(filePath, bufferSize) {
+    this->baseStream = &stream;
+  }
+  BinWritterBuffered(const BinWritterBuffered &) = delete;
+  BinWritterBuffered(BinWritterBuffered &&o)
+      : BinWritterBufferedRef(o), stream(std::move(o.stream)) {
+    this->baseStream = &stream;
+  }
+  BinWritterBuffered &operator=(const BinWritterBuffered &) = delete;
+  BinWritterBuffered &operator=(BinWritterBuffered &&o) {
+    static_cast<BinWritterBufferedRef &>(*this) = o;
+    stream = std::move(o.stream);
+    this->baseStream = &stream;
+    return *this;
+  }
+
+  void Close() { stream.Close(); }
+};
@@ -20,6 +20,7 @@
 #include "internal/bincore.hpp"
 #include "internal/sc_type.hpp"
 #include "string_view.hpp"
+#include <algorithm>
 
 template <class _Traits, bool HandleEndian>
 class BinWritterRef_t : public BinStreamNavi<_Traits> {
@@ -43,7 +44,9 @@ public:
   template <class _containerClass,
             class T = typename _containerClass::value_type>
   void WriteContainer(const _containerClass &input) const {
-    if constexpr (use_write_v<T>) {
+    if constexpr (use_write_bulk_v<T>) {
+      T::WriteBulk(*this, input.data(), input.size());
+    } else if constexpr (use_write_v<T>) {
       for (auto &item : input) {
         item.Write(*this);
       }
@@ -54,11 +57,9 @@ public:
                     size * input.size());
       };
 
-      if constexpr (size > 1) {
+      if constexpr (HandleEndian && size > 1 && use_swap_v<T>) {
         if (this->swapEndian) {
-          for (auto &item : input) {
-            Write(item);
-          }
+          WriteSwapped(input.data(), input.size());
         } else {
           wrbuffer();
         }
@@ -144,11 +145,36 @@ public:
   }
 
 private:
+  // Items are swapped in chunks within stack buffer
+  template <class T> void WriteSwapped(const T *input, size_t numItems) const {
+    constexpr size_t CHUNK_SIZE = 0x1000;
+    constexpr size_t chunkItems = std::max(CHUNK_SIZE / sizeof(T), size_t(1));
+    alignas(T) char buffer[chunkItems * sizeof(T)];
+    T *items = reinterpret_cast<T *>(buffer);
+
+    while (numItems) {
+      const size_t numChunkItems = std::min(numItems, chunkItems);
+      const size_t chunkSize = numChunkItems * sizeof(T);
+      memcpy(buffer, input, chunkSize);
+      FArraySwapper(items, numChunkItems, true);
+      WriteBuffer(buffer, chunkSize);
+      input += numChunkItems;
+      numItems -= numChunkItems;
+    }
+  }
+
   using Self = BinWritterRef_t<_Traits, HandleEndian>;
   template <class T>
   using use_write = decltype(std::declval<T>().Write(std::declval<Self>()));
   template <class C>
   constexpr static bool use_write_v = es::is_detected_v<use_write, C>;
+  // Optional static WriteBulk(writer, const T *items, size_t numItems)
+  template <class T>
+  using use_write_bulk = decltype(T::WriteBulk(
+      std::declval<Self>(), std::declval<const T *>(), size_t{}));
+  template <class C>
+  constexpr static bool use_write_bulk_v =
+      es::is_detected_v<use_write_bulk, C>;
 
   template <class T> using no_swap = decltype(std::declval<T>().NoSwap());
   template <class C>
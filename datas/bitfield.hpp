@@ -17,6 +17,8 @@
 
 #pragma once
 #include "reflector_fwd.hpp"
+#include <algorithm>
+#include <utility>
 
 template <size_t index_, size_t size_,
           class type = std::conditional_t<size_ == 1, bool, void>>
@@ -108,6 +110,65 @@ struct BitFieldType : BitField<members...> {
     SwapBitField(parent::numItems, outWay, value,
                  [](size_t id) { return parent::Get(id); });
   }
+
+  static constexpr size_t numMembers = sizeof...(members);
+
+  // Splits values into array per member (outputs[member index][item])
+  static void Unpack(const BitFieldType *input, size_t numItems,
+                     type_ *const (&outputs)[numMembers]) {
+    ForEachBlock(numItems, [&](size_t begin, size_t end) {
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        (UnpackMember<I>(input, begin, end, outputs[I]), ...);
+      }
+      (std::make_index_sequence<numMembers>{});
+    });
+  }
+
+  // Joins array per member into values, member values are masked
+  static void Pack(BitFieldType *output, size_t numItems,
+                   const type_ *const (&inputs)[numMembers]) {
+    ForEachBlock(numItems, [&](size_t begin, size_t end) {
+      std::fill(output + begin, output + end, BitFieldType{});
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        (PackMember<I>(output, begin, end, inputs[I]), ...);
+      }
+      (std::make_index_sequence<numMembers>{});
+    });
+  }
+
+private:
+  // Blocks keep packed values in cache while every member is processed
+  // Member loops use constant shift and mask, so they are vectorized
+  // PEXT/PDEP of single contiguous member is the same shift and mask
+  template <class fn> static void ForEachBlock(size_t numItems, fn &&cb) {
+    constexpr size_t BLOCK_SIZE = 0x400;
+
+    for (size_t b = 0; b < numItems; b += BLOCK_SIZE) {
+      cb(b, std::min(numItems, b + BLOCK_SIZE));
+    }
+  }
+
+  template <size_t index>
+  static void UnpackMember(const BitFieldType *input, size_t begin,
+                           size_t end, type_ *output) {
+    constexpr BitMember item = parent::Get(index);
+    constexpr type_ mask = item.GetMask<type_>();
+
+    for (size_t i = begin; i < end; i++) {
+      output[i] = (input[i].value & mask) >> item.position;
+    }
+  }
+
+  template <size_t index>
+  static void PackMember(BitFieldType *output, size_t begin, size_t end,
+                         const type_ *input) {
+    constexpr BitMember item = parent::Get(index);
+    constexpr type_ mask = item.GetMask<type_>();
+
+    for (size_t i = begin; i < end; i++) {
+      output[i].value |= (input[i] << item.position) & mask;
+    }
+  }
 };
 
 #include "internal/bitfield.inl"
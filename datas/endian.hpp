@@ -22,6 +22,12 @@
 #include "supercore.hpp"
 #include <cstring>
 #include <stdexcept>
+#include <tmmintrin.h>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace {
 
@@ -48,6 +54,54 @@ template <> constexpr uint64 _fbswap(uint64 input) {
 static_assert(_fbswap<uint16>(0xabcd) == 0xcdab);
 static_assert(_fbswap<uint32>(0x89abcdef) == 0xefcdab89);
 static_assert(_fbswap<uint64>(0x0123456789abcdef) == 0xefcdab8967452301);
+
+// Byte order of every size sized item is reversed, repeats for every lane
+template <size_t size> constexpr char _fbswapMaskByte(size_t index) {
+  return char((index / size) * size + size - 1 - index % size);
+}
+
+template <size_t size, size_t... I>
+__m128i _fbswapMask(std::index_sequence<I...>) {
+  return _mm_setr_epi8(_fbswapMaskByte<size>(I)...);
+}
+
+#ifdef __AVX2__
+template <size_t size, size_t... I>
+__m256i _fbswapMask256(std::index_sequence<I...>) {
+  return _mm256_setr_epi8(_fbswapMaskByte<size>(I)...);
+}
+#endif
+
+template <size_t size> void _fbswapBulk(char *data, size_t numItems) {
+  using type = typename es::TypeFromSize<size>::type;
+  const size_t numBytes = numItems * size;
+  size_t t = 0;
+
+#ifdef __AVX2__
+  const __m256i mask256 =
+      _fbswapMask256<size>(std::make_index_sequence<32>{});
+
+  for (; t + 32 <= numBytes; t += 32) {
+    auto cData = reinterpret_cast<__m256i *>(data + t);
+    _mm256_storeu_si256(cData,
+                        _mm256_shuffle_epi8(_mm256_loadu_si256(cData), mask256));
+  }
+#endif
+
+  const __m128i mask = _fbswapMask<size>(std::make_index_sequence<16>{});
+
+  for (; t + 16 <= numBytes; t += 16) {
+    auto cData = reinterpret_cast<__m128i *>(data + t);
+    _mm_storeu_si128(cData, _mm_shuffle_epi8(_mm_loadu_si128(cData), mask));
+  }
+
+  for (; t < numBytes; t += size) {
+    type item;
+    memcpy(&item, data + t, size);
+    item = _fbswap(item);
+    memcpy(data + t, &item, size);
+  }
+}
 } // namespace
 
 template <IsSwapableArith C> void FByteswapper(C &input, bool) {
@@ -56,18 +110,30 @@ template <IsSwapableArith C> void FByteswapper(C &input, bool) {
   memcpy(reinterpret_cast<char *>(&input), &rType, sizeof(input));
 }
 
+// Swaps numItems continuous items
+// Arithmetic and IsSwapableUniform items are swapped by vectorized kernel
+template <class C>
+void FArraySwapper(C *input, size_t numItems, bool outWay = false) {
+  if constexpr (std::is_arithmetic_v<C>) {
+    if constexpr (sizeof(C) > 1) {
+      _fbswapBulk<sizeof(C)>(reinterpret_cast<char *>(input), numItems);
+    }
+  } else if constexpr (IsSwapableUniform<C>) {
+    using item_type = typename C::swap_item_type;
+    FArraySwapper(reinterpret_cast<item_type *>(input),
+                  numItems * (sizeof(C) / sizeof(item_type)));
+  } else {
+    for (size_t t = 0; t < numItems; t++) {
+      FByteswapper(input[t], outWay);
+    }
+  }
+}
+
 template <class C, size_t _size>
 void FByteswapper(C (&input)[_size], bool outWay) {
-  for (auto &a : input) {
-    FByteswapper(a, outWay);
-  }
+  FArraySwapper(input, _size, outWay);
 }
 
 template <class E = uint32, class C> void FArraySwapper(C &input) {
-  const size_t numItems = sizeof(C) / sizeof(E);
-  E *inputPtr = reinterpret_cast<E *>(&input);
-
-  for (size_t t = 0; t < numItems; t++) {
-    FByteswapper(*(inputPtr + t));
-  }
+  FArraySwapper(reinterpret_cast<E *>(&input), sizeof(C) / sizeof(E));
 }
@@ -35,6 +35,14 @@ concept IsSwapableMemn = requires(C &t) {
   t.SwapEndian(true);
 };
 
+// Class with swap_item_type, its SwapEndian swaps every swap_item_type sized
+// word, arrays of such classes can be swapped in bulk
+template <class C>
+concept IsSwapableUniform = requires {
+  typename C::swap_item_type;
+} && std::is_arithmetic_v<typename C::swap_item_type> &&
+    sizeof(C) % sizeof(typename C::swap_item_type) == 0;
+
 template <class C>
 concept IsSwapableClass = std::is_class_v<C> && !IsSwapableMemn<C> &&
                           !IsSwapableMem<C> && !IsSwapableArith<C>;
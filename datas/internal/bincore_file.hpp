@@ -40,6 +40,12 @@ constexpr std::ios_base::openmode MakeOpenMode(BinCoreOpenMode mode) {
 
   if (mode & BinCoreOpenMode::Out) {
     retVal = retVal | std::ios_base::out;
+
+    // Writer continues at end of existing file instead of truncating it
+    if ((mode & BinCoreOpenMode::Ate) && !(mode & BinCoreOpenMode::Append) &&
+        !(mode & BinCoreOpenMode::Truncate)) {
+      retVal = retVal | std::ios_base::in;
+    }
   } else {
     retVal = retVal | std::ios_base::in;
   }
@@ -94,9 +100,14 @@ protected:
   }
 
   bool WOpen(const std::wstring &fileName) {
-    constexpr wchar_t mode[]{(OMODE & std::ios_base::in) != 0 ? 'r' : 'w',
-                             (OMODE & std::ios_base::binary) != 0 ? 'b' : 't',
-                             0};
+    constexpr bool update = (OMODE & std::ios_base::in) != 0 &&
+                            (OMODE & std::ios_base::out) != 0;
+    constexpr wchar_t accessMode = (OMODE & std::ios_base::in) != 0 ? 'r' : 'w';
+    constexpr wchar_t typeMode =
+        (OMODE & std::ios_base::binary) != 0 ? 'b' : 't';
+    constexpr wchar_t simpleMode[]{accessMode, typeMode, 0};
+    constexpr wchar_t updateMode[]{accessMode, '+', typeMode, 0};
+    const wchar_t *mode = update ? updateMode : simpleMode;
 
     FILE *cFile = _wfopen(fileName.data(), mode);
 
@@ -0,0 +1,114 @@
+/*  Memory mapped file class for Binary reader
+
+    Copyright 2018-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "../bincore_fwd.hpp"
+#include "../except.hpp"
+#include "../stat.hpp"
+#include <istream>
+#include <streambuf>
+
+// Whole mapping is get area, so seeking never refills anything
+class MappedStreamBuf : public std::streambuf {
+public:
+  MappedStreamBuf() = default;
+  MappedStreamBuf(const MappedStreamBuf &) = default;
+  MappedStreamBuf &operator=(const MappedStreamBuf &) = default;
+
+  void SetSpan(char *begin, size_t size) { setg(begin, begin, begin + size); }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    if (!(which & std::ios_base::in)) {
+      return pos_type(off_type(-1));
+    }
+
+    char *base = dir == std::ios_base::beg   ? eback()
+                 : dir == std::ios_base::cur ? gptr()
+                                             : egptr();
+    char *newPos = base + off;
+
+    if (newPos < eback() || newPos > egptr()) {
+      return pos_type(off_type(-1));
+    }
+
+    setg(eback(), newPos, egptr());
+    return pos_type(newPos - eback());
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+  std::streamsize showmanyc() override { return egptr() - gptr(); }
+};
+
+template <BinCoreOpenMode MODE> class BinStreamMapped {
+  static constexpr auto ACCESS = MODE & BinCoreOpenMode::Sequential
+                                     ? es::MappedFile::Access::Sequential
+                                     : es::MappedFile::Access::Random;
+  es::MappedFile mappedFile;
+  MappedStreamBuf buffer;
+
+protected:
+  std::istream fileStream{&buffer};
+
+  void Close_() {
+    mappedFile = {};
+    buffer.SetSpan(nullptr, 0);
+    fileStream.clear();
+  }
+
+  bool Open_(const std::string &fileName) {
+    try {
+      mappedFile =
+          es::MappedFile(fileName, es::MappedFile::Mode::Read, 0, 0, false);
+    } catch (const es::FileNotFoundError &) {
+      fileStream.setstate(std::ios_base::badbit);
+      return false;
+    }
+
+    mappedFile.Advise(ACCESS);
+    buffer.SetSpan(static_cast<char *>(mappedFile.data), mappedFile.dataSize);
+    fileStream.clear();
+
+    return true;
+  }
+
+  bool Open_(const char *fileName) { return Open_(std::string(fileName)); }
+
+  BinStreamMapped() = default;
+  BinStreamMapped(BinStreamMapped &&o)
+      : mappedFile(std::move(o.mappedFile)), buffer(o.buffer) {
+    fileStream.clear(o.fileStream.rdstate());
+  }
+  BinStreamMapped &operator=(BinStreamMapped &&o) {
+    mappedFile = std::move(o.mappedFile);
+    buffer = o.buffer;
+    fileStream.clear(o.fileStream.rdstate());
+    return *this;
+  }
+
+public:
+  bool IsValid() const { return mappedFile.fd != -1; }
+
+  // Whole file, valid while reader is open
+  es::string_view Data() const {
+    return {static_cast<const char *>(mappedFile.data), mappedFile.dataSize};
+  }
+};
@@ -0,0 +1,125 @@
+/*  Asynchronous read-ahead stream for BinReader
+
+    Copyright 2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "../bincore_fwd.hpp"
+#include "../except.hpp"
+#include "../settings.hpp"
+#include <condition_variable>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// Double buffered get area, background thread reads next block
+// while current block is consumed
+class ReadAheadStreamBuf : public std::streambuf {
+public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 0x100000;
+
+  PC_EXTERN ReadAheadStreamBuf(const std::string &path,
+                               size_t blockSize_ = DEFAULT_BLOCK_SIZE);
+  ReadAheadStreamBuf(const ReadAheadStreamBuf &) = delete;
+  ReadAheadStreamBuf &operator=(const ReadAheadStreamBuf &) = delete;
+  PC_EXTERN ~ReadAheadStreamBuf();
+
+  size_t Size() const { return fileSize; }
+
+protected:
+  PC_EXTERN int_type underflow() override;
+  PC_EXTERN pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                             std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+  std::streamsize showmanyc() override { return egptr() - gptr(); }
+
+private:
+  // Front block is get area, back block is owned by worker while pending
+  std::unique_ptr<char[]> front;
+  std::unique_ptr<char[]> back;
+  size_t blockSize;
+  size_t fileSize = 0;
+  size_t frontOffset = 0;
+  int64 fd = -1;
+
+  std::mutex mtx;
+  std::condition_variable signal;
+  size_t backOffset = 0;
+  size_t backSize = 0;
+  bool pending = false;
+  bool quit = false;
+  std::thread worker;
+
+  void Worker();
+  void Request(size_t offset);
+  void Wait();
+  bool InBack(size_t offset) const {
+    return offset >= backOffset && offset < backOffset + backSize;
+  }
+};
+
+template <BinCoreOpenMode MODE> class BinStreamReadAhead {
+  std::unique_ptr<ReadAheadStreamBuf> buffer;
+  size_t blockSize = ReadAheadStreamBuf::DEFAULT_BLOCK_SIZE;
+
+protected:
+  std::istream fileStream{nullptr};
+
+  void Close_() {
+    fileStream.rdbuf(nullptr);
+    buffer.reset();
+  }
+
+  bool Open_(const std::string &fileName) {
+    try {
+      buffer = std::make_unique<ReadAheadStreamBuf>(fileName, blockSize);
+    } catch (const es::FileNotFoundError &) {
+      fileStream.setstate(std::ios_base::badbit);
+      return false;
+    }
+
+    fileStream.rdbuf(buffer.get());
+    return true;
+  }
+
+  bool Open_(const char *fileName) { return Open_(std::string(fileName)); }
+
+  BinStreamReadAhead() = default;
+  BinStreamReadAhead(BinStreamReadAhead &&o)
+      : buffer(std::move(o.buffer)), blockSize(o.blockSize) {
+    fileStream.rdbuf(buffer.get());
+    fileStream.clear(o.fileStream.rdstate());
+    o.fileStream.rdbuf(nullptr);
+  }
+  BinStreamReadAhead &operator=(BinStreamReadAhead &&o) {
+    buffer = std::move(o.buffer);
+    blockSize = o.blockSize;
+    fileStream.rdbuf(buffer.get());
+    fileStream.clear(o.fileStream.rdstate());
+    o.fileStream.rdbuf(nullptr);
+    return *this;
+  }
+
+public:
+  bool IsValid() const { return buffer != nullptr; }
+
+  // Applied on next Open
+  void BlockSize(size_t size) { blockSize = size; }
+};
@@ -37,35 +37,145 @@ FileType_e FileType(const std::string &path) {
 }
 
 namespace es {
-MappedFile::MappedFile(const std::string &path) {
-  fd = open(path.c_str(), O_RDONLY);
+static size_t PageSize() {
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  return pageSize;
+}
+
+MappedFile::MappedFile(const std::string &path)
+    : MappedFile(path, Mode::Read, 0, 0, true) {
+  Advise(Access::Random);
+  Advise(Access::WillNeed);
+}
+
+MappedFile::MappedFile(const std::string &path, Mode mode_, size_t offset,
+                       size_t size, bool populate)
+    : dataOffset(offset), mode(mode_) {
+  fd = mode == Mode::ReadWrite ? open(path.c_str(), O_RDWR | O_CREAT, 0666)
+                               : open(path.c_str(), O_RDONLY);
   if (fd == -1) {
     throw es::FileNotFoundError(path);
   }
 
+  auto Fail = [&](const std::string &what) {
+    close(fd);
+    fd = -1;
+    throw std::runtime_error(what + path);
+  };
+
   struct stat fileStat;
   if (fstat(fd, &fileStat) == -1) {
-    throw std::runtime_error("Cannot stat file " + path);
+    Fail("Cannot stat file ");
+  }
+
+  const size_t fileSize = fileStat.st_size;
+
+  if (offset > fileSize) {
+    Fail("Mapping range is outside of file ");
+  }
+
+  const size_t maxSize = fileSize - offset;
+  dataSize = size && size < maxSize ? size : maxSize;
+
+  if (!Map(populate)) {
+    Fail("Cannot map file ");
+  }
+
+  // Mapping holds its own reference to file, descriptor is kept for Resize
+  if (mode != Mode::ReadWrite) {
+    close(fd);
+    fd = -1;
   }
+}
 
-  dataSize = fileStat.st_size;
-  data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE,
-              fd, 0);
+bool MappedFile::Map(bool populate) {
+  // Zero length mappings are invalid
+  if (!dataSize) {
+    return true;
+  }
 
-  madvise(data, dataSize, MADV_RANDOM);
-  madvise(data, dataSize, MADV_WILLNEED);
-  madvise(data, dataSize, MADV_DONTDUMP);
+  const size_t alignedOffset = dataOffset & ~(PageSize() - 1);
+  const size_t skip = dataOffset - alignedOffset;
+  const int prot = mode == Mode::Read ? PROT_READ : PROT_READ | PROT_WRITE;
+  const int flags = (mode == Mode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED) |
+                    (populate ? MAP_POPULATE : 0);
+  mappingSize = dataSize + skip;
+  mapping = mmap(nullptr, mappingSize, prot, flags, fd, alignedOffset);
 
-  if (data == MAP_FAILED) {
-    throw std::runtime_error("Cannot map file " + path);
+  if (mapping == MAP_FAILED) {
+    mapping = nullptr;
+    return false;
   }
+
+  madvise(mapping, mappingSize, MADV_DONTDUMP);
+  data = static_cast<char *>(mapping) + skip;
+
+  return true;
 }
 
-MappedFile::~MappedFile() {
-  if (data && data != MAP_FAILED) {
-    munmap(data, dataSize);
+void MappedFile::Unmap() {
+  if (mapping) {
+    munmap(mapping, mappingSize);
   }
 
+  mapping = nullptr;
+  data = nullptr;
+}
+
+void MappedFile::Advise(Access access) {
+  if (!mapping) {
+    return;
+  }
+
+  switch (access) {
+  case Access::Random:
+    madvise(mapping, mappingSize, MADV_RANDOM);
+    break;
+  case Access::Sequential:
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+    break;
+  case Access::WillNeed:
+    madvise(mapping, mappingSize, MADV_WILLNEED);
+    break;
+  case Access::HugePages:
+#ifdef MADV_HUGEPAGE
+    madvise(mapping, mappingSize, MADV_HUGEPAGE);
+#endif
+    break;
+  }
+}
+
+void MappedFile::Resize(size_t newSize) {
+  if (mode != Mode::ReadWrite) {
+    throw std::runtime_error("Cannot resize read only mapping");
+  }
+
+  Unmap();
+
+  if (ftruncate(fd, dataOffset + newSize)) {
+    throw std::runtime_error("Cannot resize mapped file");
+  }
+
+  dataSize = newSize;
+
+  if (!Map(false)) {
+    throw std::runtime_error("Cannot remap resized file");
+  }
+}
+
+void MappedFile::Sync() {
+  if (mode != Mode::ReadWrite || !mapping) {
+    return;
+  }
+
+  if (msync(mapping, mappingSize, MS_SYNC)) {
+    throw std::runtime_error("Cannot sync mapped file");
+  }
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+
   if (fd != -1) {
     close(fd);
   }
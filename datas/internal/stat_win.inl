@@ -77,34 +77,143 @@ void SetupWinApiConsole() {
   SetCurrentConsoleFontEx(consoleHandle, false, &infoEx);
 }
 
-MappedFile::MappedFile(const std::string &path) {
+static size_t PageSize() {
+  static const size_t pageSize = [] {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+  }();
+  return pageSize;
+}
+
+MappedFile::MappedFile(const std::string &path)
+    : MappedFile(path, Mode::Read, 0, 0, true) {}
+
+MappedFile::MappedFile(const std::string &path, Mode mode_, size_t offset,
+                       size_t size, bool)
+    : dataOffset(offset), mode(mode_) {
   auto cvted = es::ToUTF1632(path);
-  hdl = CreateFileW(cvted.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
-                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  const bool writeable = mode == Mode::ReadWrite;
+  hdl = CreateFileW(cvted.c_str(),
+                    writeable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                    FILE_SHARE_READ, NULL,
+                    writeable ? OPEN_ALWAYS : OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL, NULL);
   if (hdl == INVALID_HANDLE_VALUE) {
     throw es::FileNotFoundError(path);
   }
 
-  auto fileSize = GetFileSize(hdl, NULL);
-  HANDLE mapping = CreateFileMapping(hdl, NULL, PAGE_READONLY, 0, 0, NULL);
+  auto Fail = [&](const std::string &what) {
+    CloseHandle(hdl);
+    hdl = INVALID_HANDLE_VALUE;
+    throw std::runtime_error(what + path);
+  };
+
+  LARGE_INTEGER fileSizeLI;
+  if (!GetFileSizeEx(hdl, &fileSizeLI)) {
+    Fail("Cannot stat file ");
+  }
+
+  const size_t fileSize = fileSizeLI.QuadPart;
+
+  if (offset > fileSize) {
+    Fail("Mapping range is outside of file ");
+  }
+
+  const size_t maxSize = fileSize - offset;
+  dataSize = size && size < maxSize ? size : maxSize;
+
+  if (!Map(false)) {
+    Fail("Cannot map file ");
+  }
+
+  // Mapping holds its own reference to file, handle is kept for Resize
+  if (mode != Mode::ReadWrite) {
+    CloseHandle(hdl);
+    hdl = INVALID_HANDLE_VALUE;
+  }
+}
+
+bool MappedFile::Map(bool) {
+  // Zero length mappings are invalid
+  if (!dataSize) {
+    return true;
+  }
+
+  const size_t alignedOffset = dataOffset & ~(PageSize() - 1);
+  const size_t skip = dataOffset - alignedOffset;
+  const DWORD protect = mode == Mode::Read        ? PAGE_READONLY
+                        : mode == Mode::ReadWrite ? PAGE_READWRITE
+                                                  : PAGE_WRITECOPY;
+  const DWORD access = mode == Mode::Read        ? FILE_MAP_READ
+                       : mode == Mode::ReadWrite ? FILE_MAP_WRITE
+                                                 : FILE_MAP_COPY;
+  HANDLE fileMapping = CreateFileMapping(hdl, NULL, protect, 0, 0, NULL);
+
+  if (!fileMapping) {
+    return false;
+  }
+
+  mappingSize = dataSize + skip;
+  mapping = MapViewOfFileEx(fileMapping, access, DWORD(alignedOffset >> 32),
+                            DWORD(alignedOffset), mappingSize, NULL);
+  CloseHandle(fileMapping);
 
   if (!mapping) {
-    throw std::runtime_error("Cannot map file " + path);
+    return false;
   }
 
-  data = MapViewOfFileEx(mapping, FILE_MAP_READ, 0, 0, fileSize, NULL);
-  CloseHandle(mapping);
+  data = static_cast<char *>(mapping) + skip;
 
-  if (!data) {
-    throw std::runtime_error("Cannot map file " + path);
+  return true;
+}
+
+void MappedFile::Unmap() {
+  if (mapping) {
+    UnmapViewOfFile(mapping);
   }
+
+  mapping = nullptr;
+  data = nullptr;
 }
 
-MappedFile::~MappedFile() {
-  if (data) {
-    UnmapViewOfFile(data);
+// No madvise equivalent, prefetching is left to system
+void MappedFile::Advise(Access) {}
+
+void MappedFile::Resize(size_t newSize) {
+  if (mode != Mode::ReadWrite) {
+    throw std::runtime_error("Cannot resize read only mapping");
   }
 
+  Unmap();
+
+  LARGE_INTEGER newEnd;
+  newEnd.QuadPart = dataOffset + newSize;
+
+  if (!SetFilePointerEx(hdl, newEnd, NULL, FILE_BEGIN) || !SetEndOfFile(hdl)) {
+    throw std::runtime_error("Cannot resize mapped file");
+  }
+
+  dataSize = newSize;
+
+  if (!Map(false)) {
+    throw std::runtime_error("Cannot remap resized file");
+  }
+}
+
+void MappedFile::Sync() {
+  if (mode != Mode::ReadWrite || !mapping) {
+    return;
+  }
+
+  if (!FlushViewOfFile(mapping, mappingSize) || !FlushFileBuffers(hdl)) {
+    throw std::runtime_error("Cannot sync mapped file");
+  }
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+
   if (hdl != INVALID_HANDLE_VALUE) {
     CloseHandle(hdl);
   }
@@ -17,6 +17,10 @@
 
 #include "master_printer.hpp"
 #include "flags.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
@@ -24,6 +28,59 @@
 
 using namespace es::print;
 
+// Single producer (owning thread), single consumer (printer thread)
+struct MessageRing {
+  struct Slot {
+    Queuer que;
+    uint64 seq;
+  };
+
+  std::vector<Slot> slots;
+  size_t mask;
+  uint32 generation;
+  alignas(64) std::atomic_size_t head{0};
+  alignas(64) std::atomic_size_t tail{0};
+
+  MessageRing(size_t capacity, uint32 generation_)
+      : slots(capacity), mask(capacity - 1), generation(generation_) {}
+
+  bool Push(Slot &&item) {
+    const size_t cTail = tail.load(std::memory_order_relaxed);
+
+    if (cTail - head.load(std::memory_order_acquire) > mask) {
+      return false;
+    }
+
+    slots[cTail & mask] = std::move(item);
+    tail.store(cTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <class fn> void Drain(fn &&cb) {
+    size_t cHead = head.load(std::memory_order_relaxed);
+    const size_t cTail = tail.load(std::memory_order_acquire);
+
+    for (; cHead != cTail; cHead++) {
+      cb(std::move(slots[cHead & mask]));
+    }
+
+    head.store(cHead, std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return head.load(std::memory_order_acquire) ==
+           tail.load(std::memory_order_acquire);
+  }
+};
+
+struct ThreadPrinter {
+  std::stringstream buffer;
+  MPType cType = MPType::MSG;
+  std::shared_ptr<MessageRing> ring;
+};
+
+static thread_local ThreadPrinter THREAD_PRINTER;
+
 static struct MasterPrinter {
   struct FuncType {
     print_func func;
@@ -34,47 +91,39 @@ static struct MasterPrinter {
 
   std::vector<FuncType> functions;
   std::vector<queue_func> queues;
-  std::stringstream buffer;
   std::mutex mutex;
-  std::thread::id lockedThread;
   bool printThreadID = false;
-  MPType cType = MPType::MSG;
-} MASTER_PRINTER;
+  std::atomic_uint8_t levelMask{0xff};
 
-namespace es::print {
+  std::vector<std::shared_ptr<MessageRing>> rings;
+  std::mutex ringsMutex;
+  // Published by StartAsync, capacity is stored before generation
+  std::atomic_size_t ringCapacity{0};
+  std::atomic_uint32_t generation{0};
+  std::atomic_bool async{false};
+  std::atomic_size_t inFlight{0};
+  std::atomic_uint64_t sequence{0};
+  // Number of ring messages sent to printers and queuers
+  std::atomic_uint64_t dispatched{0};
+  std::atomic<wait_func> waitHook{nullptr};
+  std::atomic_bool sleeping{false};
+  std::atomic_bool stop{false};
+  std::mutex wakeMutex;
+  std::condition_variable wake;
+  std::thread printer;
 
-void AddPrinterFunction(print_func func, bool useColor) {
-  for (auto &[func_, _] : MASTER_PRINTER.functions) {
-    if (func_ == func) {
-      return;
-    }
-  }
-  MASTER_PRINTER.functions.emplace_back(func, useColor);
-}
+  void Dispatch(const Queuer &que);
+  bool DrainRings();
+  void PrinterLoop();
+  void Stop();
 
-void AddQueuer(queue_func func) { MASTER_PRINTER.queues.push_back(func); }
-
-std::ostream &Get(MPType type) {
-  if (auto threadID = std::this_thread::get_id();
-      !(MASTER_PRINTER.lockedThread == threadID)) {
-    MASTER_PRINTER.mutex.lock();
-    MASTER_PRINTER.lockedThread = threadID;
-  }
-
-  if (type != MPType::PREV) {
-    MASTER_PRINTER.cType = type;
-  }
-  return MASTER_PRINTER.buffer;
-}
+  ~MasterPrinter() { Stop(); }
+} MASTER_PRINTER;
 
-void FlushAll() {
-  Queuer que;
-  que.payload = MASTER_PRINTER.buffer.str();
-  std::thread::id threadID = std::this_thread::get_id();
-  que.threadId = reinterpret_cast<uint32 &>(threadID);
-  que.type = MASTER_PRINTER.cType;
+void MasterPrinter::Dispatch(const Queuer &que) {
+  std::lock_guard<std::mutex> lg(mutex);
 
-  for (auto &[func, useColor] : MASTER_PRINTER.functions) {
+  for (auto &[func, useColor] : functions) {
     if (useColor) {
       if (que.type == MPType::WRN) {
         func("\033[38;2;255;255;0m");
@@ -85,7 +134,7 @@ void FlushAll() {
       }
     }
 
-    if (MASTER_PRINTER.printThreadID) {
+    if (printThreadID) {
       func("Thread[0x");
       char buffer[65];
       snprintf(buffer, 65, "%X", que.threadId);
@@ -106,15 +155,199 @@ void FlushAll() {
     }
   }
 
-  for (auto &q : MASTER_PRINTER.queues) {
+  for (auto &q : queues) {
     q(que);
   }
+}
+
+// Collects messages from every thread and prints them in FlushAll order
+bool MasterPrinter::DrainRings() {
+  std::vector<MessageRing::Slot> messages;
+
+  {
+    std::lock_guard<std::mutex> lg(ringsMutex);
+
+    for (auto &r : rings) {
+      r->Drain([&](MessageRing::Slot &&item) {
+        messages.emplace_back(std::move(item));
+      });
+    }
+
+    // Rings of finished threads
+    rings.erase(std::remove_if(rings.begin(), rings.end(),
+                               [](auto &r) {
+                                 return r.use_count() == 1 && r->Empty();
+                               }),
+                rings.end());
+  }
+
+  std::sort(messages.begin(), messages.end(),
+            [](auto &a, auto &b) { return a.seq < b.seq; });
+
+  for (auto &m : messages) {
+    Dispatch(m.que);
+  }
+
+  dispatched.fetch_add(messages.size(), std::memory_order_release);
+
+  return !messages.empty();
+}
+
+void MasterPrinter::PrinterLoop() {
+  while (!stop.load(std::memory_order_acquire)) {
+    if (DrainRings()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(wakeMutex);
+    sleeping.store(true);
+    // Timeout covers a producer that pushed before we went to sleep
+    wake.wait_for(lk, std::chrono::milliseconds(20));
+    sleeping.store(false);
+  }
+
+  DrainRings();
+}
+
+void MasterPrinter::Stop() {
+  async.store(false);
+
+  while (inFlight.load()) {
+    std::this_thread::yield();
+  }
+
+  if (printer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lk(wakeMutex);
+      stop.store(true);
+    }
+    wake.notify_one();
+    printer.join();
+  }
+
+  std::lock_guard<std::mutex> lg(ringsMutex);
+  rings.clear();
+  stop.store(false);
+}
+
+namespace es::print {
+
+void AddPrinterFunction(print_func func, bool useColor) {
+  std::lock_guard<std::mutex> lg(MASTER_PRINTER.mutex);
+  for (auto &[func_, _] : MASTER_PRINTER.functions) {
+    if (func_ == func) {
+      return;
+    }
+  }
+  MASTER_PRINTER.functions.emplace_back(func, useColor);
+}
+
+void AddQueuer(queue_func func) {
+  std::lock_guard<std::mutex> lg(MASTER_PRINTER.mutex);
+  MASTER_PRINTER.queues.push_back(func);
+}
 
-  MASTER_PRINTER.buffer.str("");
-  MASTER_PRINTER.cType = MPType::MSG;
-  MASTER_PRINTER.mutex.unlock();
-  MASTER_PRINTER.lockedThread = {};
+std::ostream &Get(MPType type) {
+  if (type != MPType::PREV) {
+    THREAD_PRINTER.cType = type;
+  }
+  return THREAD_PRINTER.buffer;
+}
+
+void FlushAll() {
+  auto &tp = THREAD_PRINTER;
+  Queuer que;
+  que.payload = tp.buffer.str();
+  std::thread::id threadID = std::this_thread::get_id();
+  que.threadId = reinterpret_cast<uint32 &>(threadID);
+  que.type = tp.cType;
+  tp.buffer.str("");
+  tp.cType = MPType::MSG;
+
+  MASTER_PRINTER.inFlight.fetch_add(1);
+
+  if (!MASTER_PRINTER.async.load()) {
+    MASTER_PRINTER.inFlight.fetch_sub(1);
+    MASTER_PRINTER.Dispatch(que);
+    return;
+  }
+
+  const uint32 generation =
+      MASTER_PRINTER.generation.load(std::memory_order_acquire);
+
+  if (!tp.ring || tp.ring->generation != generation) {
+    tp.ring = std::make_shared<MessageRing>(
+        MASTER_PRINTER.ringCapacity.load(std::memory_order_relaxed),
+        generation);
+    std::lock_guard<std::mutex> lg(MASTER_PRINTER.ringsMutex);
+    MASTER_PRINTER.rings.push_back(tp.ring);
+  }
+
+  MessageRing::Slot item{std::move(que), MASTER_PRINTER.sequence.fetch_add(
+                                             1, std::memory_order_relaxed)};
+
+  if (!tp.ring->Push(std::move(item))) {
+    const wait_func hook =
+        MASTER_PRINTER.waitHook.load(std::memory_order_relaxed);
+
+    if (hook) {
+      hook(true);
+    }
+
+    do {
+      MASTER_PRINTER.wake.notify_one();
+      std::this_thread::yield();
+    } while (!tp.ring->Push(std::move(item)));
+
+    if (hook) {
+      hook(false);
+    }
+  }
+
+  MASTER_PRINTER.inFlight.fetch_sub(1);
+
+  if (MASTER_PRINTER.sleeping.load(std::memory_order_relaxed)) {
+    MASTER_PRINTER.wake.notify_one();
+  }
 }
 
 void PrintThreadID(bool yn) { MASTER_PRINTER.printThreadID = yn; }
+
+void LevelMask(uint8 mask) { MASTER_PRINTER.levelMask = mask; }
+
+bool LevelEnabled(MPType type) {
+  return MASTER_PRINTER.levelMask.load(std::memory_order_relaxed) &
+         (1 << int(type));
+}
+
+void StartAsync(size_t queueCapacity) {
+  if (MASTER_PRINTER.printer.joinable()) {
+    return;
+  }
+
+  size_t capacity = 1;
+
+  while (capacity < queueCapacity) {
+    capacity <<= 1;
+  }
+
+  MASTER_PRINTER.ringCapacity.store(capacity, std::memory_order_relaxed);
+  MASTER_PRINTER.generation.fetch_add(1, std::memory_order_release);
+  MASTER_PRINTER.printer = std::thread([] { MASTER_PRINTER.PrinterLoop(); });
+  MASTER_PRINTER.async.store(true);
+}
+
+void StopAsync() { MASTER_PRINTER.Stop(); }
+
+void AsyncWaitHook(wait_func func) { MASTER_PRINTER.waitHook = func; }
+
+void WaitAsync() {
+  const uint64 queued = MASTER_PRINTER.sequence.load();
+
+  while (MASTER_PRINTER.async.load() &&
+         MASTER_PRINTER.dispatched.load(std::memory_order_acquire) < queued) {
+    MASTER_PRINTER.wake.notify_one();
+    std::this_thread::yield();
+  }
+}
 } // namespace es::print
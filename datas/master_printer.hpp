@@ -21,28 +21,25 @@
 #include <iosfwd>
 #include <string>
 
-#define printerror(...)                                                        \
-  {                                                                            \
-    es::print::Get(es::print::MPType::ERR) << __VA_ARGS__ << std::endl;        \
-    es::print::FlushAll();                                                     \
-  }
-#define printwarning(...)                                                      \
-  {                                                                            \
-    es::print::Get(es::print::MPType::WRN) << __VA_ARGS__ << std::endl;        \
-    es::print::FlushAll();                                                     \
-  }
-#define printline(...)                                                         \
-  {                                                                            \
-    es::print::Get(es::print::MPType::MSG) << __VA_ARGS__ << std::endl;        \
-    es::print::FlushAll();                                                     \
-  }
+// Compile time filter, bit mask of enabled MPType levels (1 << MPType)
+// Disabled levels are discarded before any formatting happens.
+#ifndef PRINT_LEVEL_MASK
+#define PRINT_LEVEL_MASK 0xff
+#endif
 
-#define printinfo(...)                                                         \
+#define PC_PRINT_AT_LEVEL(level, ...)                                          \
   {                                                                            \
-    es::print::Get(es::print::MPType::INF) << __VA_ARGS__ << std::endl;        \
-    es::print::FlushAll();                                                     \
+    if (es::print::IsEnabled<es::print::MPType::level>()) {                    \
+      es::print::Get(es::print::MPType::level) << __VA_ARGS__ << std::endl;    \
+      es::print::FlushAll();                                                   \
+    }                                                                          \
   }
 
+#define printerror(...) PC_PRINT_AT_LEVEL(ERR, __VA_ARGS__)
+#define printwarning(...) PC_PRINT_AT_LEVEL(WRN, __VA_ARGS__)
+#define printline(...) PC_PRINT_AT_LEVEL(MSG, __VA_ARGS__)
+#define printinfo(...) PC_PRINT_AT_LEVEL(INF, __VA_ARGS__)
+
 namespace es::print {
 using print_func = void (*)(const char *);
 enum class MPType { PREV, MSG, WRN, ERR, INF };
@@ -53,13 +50,37 @@ struct Queuer {
 };
 
 using queue_func = void (*)(const Queuer &);
+// Called with true before producer waits for space in full async queue and
+// with false after
+using wait_func = void (*)(bool);
 
-// Calling this will lock other threads that will try to access stream until
-// FlushAll is called!
+// Returns calling thread's own stream, message is finished by FlushAll
 std::ostream PC_EXTERN &Get(MPType type = MPType::PREV);
 void PC_EXTERN AddPrinterFunction(print_func func, bool useColor = true);
 void PC_EXTERN AddQueuer(queue_func func);
-// Unlocks other threads access to Get
+// Sends thread's message to printers and queuers
 void PC_EXTERN FlushAll();
 void PC_EXTERN PrintThreadID(bool yn);
+
+// Runtime filter, bit mask of enabled MPType levels (1 << MPType)
+void PC_EXTERN LevelMask(uint8 mask);
+bool PC_EXTERN LevelEnabled(MPType type);
+
+template <MPType type> bool IsEnabled() {
+  if constexpr (!(PRINT_LEVEL_MASK & (1 << int(type)))) {
+    return false;
+  } else {
+    return LevelEnabled(type);
+  }
+}
+
+// Printers and queuers will be called from a background thread.
+// FlushAll only moves message into calling thread's lock-free queue.
+// queueCapacity is number of messages per thread, rounded to power of 2
+void PC_EXTERN StartAsync(size_t queueCapacity = 256);
+// Waits for all queued messages to be printed and stops background thread.
+void PC_EXTERN StopAsync();
+// Waits until messages queued so far are sent to printers and queuers.
+void PC_EXTERN WaitAsync();
+void PC_EXTERN AsyncWaitHook(wait_func func);
 } // namespace es::print
@@ -23,6 +23,7 @@
 namespace es {
 class Matrix44 {
 public:
+  using swap_item_type = float;
   Vector4A16 v[4];
   PC_EXTERN Matrix44();
   Matrix44(const Vector4A16 &row1, const Vector4A16 &row2,
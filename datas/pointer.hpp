@@ -18,6 +18,8 @@
 #pragma once
 #include "supercore.hpp"
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <vector>
 
 namespace es {
@@ -27,6 +29,17 @@ using use_push_back = decltype(std::declval<T>().push_back(
 template <class C>
 constexpr static bool use_push_back_v = es::is_detected_v<use_push_back, C>;
 
+// Lookup containers (set, unordered_set) are searched without linear scan
+template <class container, class T>
+bool CheckStored(container &store, T *ptr) {
+  if constexpr (requires { store.find(ptr); }) {
+    return store.find(ptr) != store.end();
+  } else {
+    return std::any_of(store.begin(), store.end(),
+                       [&](auto i) { return i == ptr; });
+  }
+}
+
 template <class C> union PointerX64 {
   typedef C value_type;
 
@@ -49,12 +62,7 @@ public:
   const C *operator->() const { return pointer; }
 
   template <class container> bool Check(container &store) const {
-    if (std::any_of(store.begin(), store.end(),
-                    [&](auto i) { return i == &varPtr; })) {
-      return true;
-    }
-
-    return false;
+    return CheckStored(store, const_cast<uint64 *>(&varPtr));
   }
 
   template <class container = void>
@@ -122,12 +130,7 @@ public:
   const C *operator->() const { return *this; }
 
   template <class container> bool Check(container &store) const {
-    if (std::any_of(store.begin(), store.end(),
-                    [&](auto i) { return i == &varPtr; })) {
-      return true;
-    }
-
-    return false;
+    return CheckStored(store, const_cast<Store *>(&varPtr));
   }
 
   template <class container>
@@ -213,6 +216,79 @@ bool FixupPointersCB(const char *root, container &store, fn &&notFixedCB,
   return true;
 }
 
+// Batch fixup of pointers within single buffer
+// Pointer locations are gathered first (relocation table or layout walk),
+// then deduplicated and rebased in single pass ordered by address
+// Already fixed locations are skipped by subsequent passes
+class PointerRelocator {
+public:
+  PointerRelocator(char *root_) : root(root_) {}
+
+  template <class P> void Add(P &ptr) {
+    locations.push_back(reinterpret_cast<char *>(&ptr) - root);
+  }
+
+  // Offset from root
+  void Add(size_t offset) { locations.push_back(offset); }
+
+  // Relocation table of offsets from root
+  template <class C> void AddTable(const C &offsets) {
+    locations.insert(locations.end(), std::begin(offsets), std::end(offsets));
+  }
+
+  template <class Store = int32> size_t FixupX86() {
+    return Apply<Store>([](Store value, size_t location) {
+      // relative to root -> relative to pointer
+      return value ? static_cast<Store>(value - location) : value;
+    });
+  }
+
+  size_t FixupX64() {
+    const uint64 base = reinterpret_cast<uintptr_t>(root);
+    return Apply<uint64>([base](uint64 value, size_t) {
+      return value ? value + base : value;
+    });
+  }
+
+  size_t NumFixed() const { return fixed.size(); }
+
+private:
+  char *root;
+  std::vector<size_t> locations;
+  std::vector<size_t> fixed;
+
+  // Returns number of newly fixed locations
+  template <class Store, class fn> size_t Apply(fn &&rebase) {
+    std::sort(locations.begin(), locations.end());
+    locations.erase(std::unique(locations.begin(), locations.end()),
+                    locations.end());
+
+    if (!fixed.empty()) {
+      locations.erase(std::remove_if(locations.begin(), locations.end(),
+                                     [&](size_t loc) {
+                                       return std::binary_search(
+                                           fixed.begin(), fixed.end(), loc);
+                                     }),
+                      locations.end());
+    }
+
+    for (size_t loc : locations) {
+      Store value;
+      memcpy(&value, root + loc, sizeof(Store));
+      value = rebase(value, loc);
+      memcpy(root + loc, &value, sizeof(Store));
+    }
+
+    const size_t numFixed = locations.size();
+    const size_t oldSize = fixed.size();
+    fixed.insert(fixed.end(), locations.begin(), locations.end());
+    std::inplace_merge(fixed.begin(), fixed.begin() + oldSize, fixed.end());
+    locations.clear();
+
+    return numFixed;
+  }
+};
+
 } // namespace es
 
 template <class C> using esPointerX64 = es::PointerX64<C>;
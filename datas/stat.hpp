@@ -20,6 +20,7 @@
 #include "settings.hpp"
 #include "unicode.hpp"
 #include <set>
+#include <utility>
 
 enum FileType_e {
   Error,
@@ -48,32 +49,67 @@ void RemoveFile(const std::string &path);
 void MKDIR_EXTERN_ SetupWinApiConsole();
 
 struct MappedFile {
+  // Page access hints, Random by default
+  enum class Access {
+    Random,
+    Sequential,
+    WillNeed, // Pages are read ahead in background
+    HugePages, // Transparent huge pages, if supported by filesystem
+  };
+
+  enum class Mode {
+    Read,
+    ReadWrite, // File is created if it doesn't exist
+    CopyOnWrite, // Writes are private and never reach file
+  };
+
   void *data = nullptr;
   size_t dataSize = 0;
+  // Open only in ReadWrite mode, other modes close it after mapping
   union {
     int64 fd = -1;
     void *hdl;
   };
 
+  // Whole file, read only, pages are populated
   PC_EXTERN
   MappedFile(const std::string &path);
+  // Range of file, size 0 maps up to the end of file
+  // Offset doesn't have to be page aligned
+  PC_EXTERN MappedFile(const std::string &path, Mode mode, size_t offset = 0,
+                       size_t size = 0, bool populate = false);
   MappedFile() = default;
   MappedFile(const MappedFile &) = delete;
-  MappedFile(MappedFile &&other)
-      : data(other.data), dataSize(other.dataSize), fd(other.fd) {
-    other.data = nullptr;
-    other.fd = -1;
-  }
+  MappedFile(MappedFile &&other) { *this = std::move(other); }
 
+  // Previous mapping is released by other
   MappedFile &operator=(MappedFile &&other) {
-    data = other.data;
-    dataSize = other.dataSize;
-    fd = other.fd;
-    other.data = nullptr;
-    other.fd = -1;
+    std::swap(data, other.data);
+    std::swap(dataSize, other.dataSize);
+    std::swap(fd, other.fd);
+    std::swap(mapping, other.mapping);
+    std::swap(mappingSize, other.mappingSize);
+    std::swap(dataOffset, other.dataOffset);
+    std::swap(mode, other.mode);
     return *this;
   }
   PC_EXTERN ~MappedFile();
+  void PC_EXTERN Advise(Access access);
+  // ReadWrite only, file size is set to offset + newSize and range is
+  // remapped, data pointer changes
+  void PC_EXTERN Resize(size_t newSize);
+  // ReadWrite only, writes dirty pages into file
+  void PC_EXTERN Sync();
+
+private:
+  // Page aligned mapping that contains data
+  void *mapping = nullptr;
+  size_t mappingSize = 0;
+  size_t dataOffset = 0;
+  Mode mode = Mode::Read;
+
+  bool Map(bool populate);
+  void Unmap();
 };
 
 } // namespace es
@@ -34,6 +34,7 @@ template <typename T> class t_Vector2 {
 
 public:
   using value_type = T;
+  using swap_item_type = T;
   using shift_value = int32;
   using shift_vec = const t_Vector2<shift_value> &;
   union {
@@ -160,6 +161,7 @@ template <typename T> class t_Vector {
 
 public:
   using value_type = T;
+  using swap_item_type = T;
   using shift_value = int32;
   using shift_vec = const t_Vector<shift_value> &;
   union {
@@ -407,6 +409,7 @@ template <class C> class t_Vector4_ : public C {
 public:
   using C::C;
   using value_type = typename C::value_type;
+  using swap_item_type = value_type;
   t_Vector4_() = default;
   t_Vector4_(const C &input) : C(input) {}
   t_Vector4_(C &&input) : C(input) {}
@@ -19,13 +19,22 @@
 #include "console.hpp"
 #include "datas/master_printer.hpp"
 #include "datas/tchar.hpp"
+#include "trace.hpp"
 #include <algorithm>
+#include <condition_variable>
 #include <csignal>
+#include <cstdio>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 #if defined(_MSC_VER) || defined(__MINGW64__)
 #define USEWIN
+#include <io.h>
+#define isatty _isatty
+#define fileno _fileno
+#else
+#include <unistd.h>
 #endif
 
 const size_t nextTickMS = 100;
@@ -39,32 +48,36 @@ const char8_t *barchars[] = {
     u8"\u284F", u8"\u285F", u8"\u287F", u8"\u28FF",
 };
 
-void ProgressBar::PrintLine() {
+static void Append(std::string &out, const char8_t *data) {
+  out.append(reinterpret_cast<const char *>(data));
+}
+
+void ProgressBar::PrintLine(std::string &out) {
   const size_t width = 50;
   const float normState = std::min(curitem * itemDelta, 1.f);
   const size_t state = normState * width;
-  es::Print(label.data());
-  es::Print("\033[38;2;168;204;140m");
+  out.append(label.data(), label.size());
+  out.append("\033[38;2;168;204;140m");
 
   for (size_t i = 0; i < state; i++) {
 #ifdef USEWIN
-    es::Print("#");
+    out.push_back('#');
 #else
-    es::Print(u8"\u25A0");
+    Append(out, u8"\u25A0");
 #endif
   }
 
-  for (size_t i = state; i < width; i++) {
-    es::Print(" ");
+  if (state < width) {
+    out.append(width - state, ' ');
   }
 
   char percBuffer[16]{};
   snprintf(percBuffer, sizeof(percBuffer), "\033[0m %3u%% ",
            uint32(normState * 100));
-  es::Print(percBuffer);
+  out.append(percBuffer);
 }
 
-void DetailedProgressBar::PrintLine() {
+void DetailedProgressBar::PrintLine(std::string &out) {
   const size_t goal = curitem;
   const size_t width = 50;
   const size_t parts = 8;
@@ -81,137 +94,224 @@ void DetailedProgressBar::PrintLine() {
   const size_t stateMacro = normState * width;
   const size_t state = size_t(normState * width * parts) % parts;
 
-  es::Print(label.data());
-  es::Print("\033[38;2;168;204;140m");
+  out.append(label.data(), label.size());
+  out.append("\033[38;2;168;204;140m");
 
   for (size_t i = 0; i < stateMacro; i++) {
-    es::Print(barchars[7]);
+    Append(out, barchars[7]);
   }
 
   if (state) {
-    es::Print(barchars[state]);
+    Append(out, barchars[state]);
   }
 
-  for (size_t i = stateMacro + bool(state); i < width; i++) {
-    es::Print(" ");
+  if (const size_t filled = stateMacro + bool(state); filled < width) {
+    out.append(width - filled, ' ');
   }
 
   char percBuffer[16]{};
   snprintf(percBuffer, sizeof(percBuffer), "\033[0m %3u%% ",
            uint32(normState * 100));
-  es::Print(percBuffer);
+  out.append(percBuffer);
 }
 
-void LoadingBar::PrintLine() {
+void LoadingBar::PrintLine(std::string &out) {
   if (!state) {
     const size_t loopTick = (innerTick / 100) % 6;
-    es::Print(loopchars[loopTick]);
-    es::Print(" ");
+    Append(out, loopchars[loopTick]);
+    out.push_back(' ');
   } else if (state == 1) {
-    es::Print(u8"\033[38;2;168;220;140m\u2714 \033[0m");
+    Append(out, u8"\033[38;2;168;220;140m\u2714 \033[0m");
   } else {
-    es::Print(u8"\u274C ");
+    Append(out, u8"\u274C ");
   }
 
-  es::Print(payload.data());
+  out.append(payload.data());
   innerTick += nextTickMS;
 }
 
-static std::atomic_uint8_t pauseLogger{0};
-static std::vector<es::print::Queuer> messageQueues[2];
+struct ConsoleMessage {
+  es::print::Queuer que;
+  uint8 detail;
+};
+
+// Everything below is guarded by consoleMutex
+static std::mutex consoleMutex;
+static std::condition_variable consoleSignal;
+static std::vector<ConsoleMessage> messageQueue;
 static std::vector<std::unique_ptr<LogLine>> lineQueue;
-static std::atomic<bool> messageQueueOrder;
+static bool linesChanged = false;
+static bool stopLogger = false;
+static uint8 printDetail = 0;
+
 static std::thread logger;
-static std::atomic_uint8_t printDetail{0};
-static std::atomic_uint64_t newPrintDetailSince{0};
+static bool isTTY = false;
 
 void ReceiveQueue(const es::print::Queuer &que) {
-  messageQueues[messageQueueOrder].push_back(que);
+  {
+    std::lock_guard<std::mutex> lg(consoleMutex);
+    messageQueue.push_back({que, printDetail});
+  }
+  consoleSignal.notify_one();
 }
 
-void MakeLogger() {
-  size_t innerTick = 0;
-  messageQueueOrder = false;
-  bool mustClear = false;
-
-  while (true) {
-    if (mustClear) {
-      es::Print("\033[J");
-      mustClear = false;
+static void AppendMessage(std::string &frame, const ConsoleMessage &msg) {
+  auto &l = msg.que;
+  bool colored = isTTY && (msg.detail & 1);
+
+  if (colored) {
+    using es::print::MPType;
+    switch (l.type) {
+    case MPType::ERR:
+      Append(frame, u8"\033[38;2;255;50;50m\u26D4 ");
+      break;
+    case MPType::INF:
+      Append(frame, u8"\033[38;2;50;120;255m \u2139 ");
+      break;
+    case MPType::WRN:
+      Append(frame, u8"\033[38;2;255;255;50m\u26A0  ");
+      break;
+    default:
+      frame.append("\033[0m   ");
+      colored = false;
+      break;
     }
+  }
 
-    if (bool mqo = messageQueueOrder; !messageQueues[mqo].empty()) {
-      messageQueueOrder = !mqo;
-      uint8 fullDetail = printDetail;
-      uint64 newDetailSince = newPrintDetailSince.exchange(0);
-      size_t curQue = 0;
-
-      for (auto &l : messageQueues[mqo]) {
-        uint8 detail = newDetailSince <= curQue ? fullDetail : fullDetail >> 4;
-        bool colored = detail & 1;
-        if (colored) {
-          using es::print::MPType;
-          switch (l.type) {
-          case MPType::ERR:
-            es::Print(u8"\033[38;2;255;50;50m\u26D4 ");
-            break;
-          case MPType::INF:
-            es::Print(u8"\033[38;2;50;120;255m \u2139 ");
-            break;
-          case MPType::WRN:
-            es::Print(u8"\033[38;2;255;255;50m\u26A0  ");
-            break;
-          default:
-            es::Print(u8"\033[0m   ");
-            colored = false;
-            break;
-          }
-        }
+  if (msg.detail & 2) {
+    char threadBuffer[16]{};
+    snprintf(threadBuffer, sizeof(threadBuffer), "[0x%.8X] ", l.threadId);
+    frame.append(threadBuffer);
+  }
 
-        if (detail & 2) {
-          char threadBuffer[16]{};
-          snprintf(threadBuffer, sizeof(threadBuffer), "[0x%.8X] ", l.threadId);
-          es::Print(threadBuffer);
-        }
+  frame.append(l.payload);
+
+  if (colored) {
+    frame.append("\033[0m");
+  }
+}
 
-        es::Print(l.payload.data());
+// Whole frame is sent in one write
+static void WriteFrame(const std::string &frame) {
+  if (frame.empty()) {
+    return;
+  }
 
-        if (colored) {
-          es::Print(u8"\033[0m");
-        }
+  fwrite(frame.data(), 1, frame.size(), stdout);
+  fflush(stdout);
+}
 
-        curQue++;
+void MakeLogger() {
+  std::vector<ConsoleMessage> messages;
+  // Last rendered state of lines, cursor is kept at first line
+  std::vector<std::string> drawnLines;
+  std::vector<std::string> newLines;
+  std::string frame;
+  bool stopping = false;
+
+  while (!stopping) {
+    {
+      std::unique_lock<std::mutex> lk(consoleMutex);
+      auto Ready = [] {
+        return stopLogger || !messageQueue.empty() || linesChanged;
+      };
+
+      if (isTTY && !lineQueue.empty()) {
+        // Animated lines need periodic redraw
+        consoleSignal.wait_for(lk, std::chrono::milliseconds(nextTickMS),
+                               Ready);
+      } else {
+        consoleSignal.wait(lk, Ready);
       }
 
-      messageQueues[mqo].clear();
-    }
+      std::swap(messages, messageQueue);
+      stopping = stopLogger;
+      const bool forceRedraw = linesChanged;
+      linesChanged = false;
+      newLines.resize(isTTY && !stopping ? lineQueue.size() : 0);
 
-    if (uint8 state = pauseLogger; state || lineQueue.empty()) {
-      if (state > 1) {
-        break;
-      } else {
-        continue;
+      for (size_t i = 0; i < newLines.size(); i++) {
+        newLines[i].clear();
+        lineQueue[i]->PrintLine(newLines[i]);
+      }
+
+      if (forceRedraw) {
+        drawnLines.clear();
       }
     }
 
-    for (auto &l : lineQueue) {
-      l->PrintLine();
-      es::Print("\n");
+    frame.clear();
+
+    if (!isTTY) {
+      for (auto &m : messages) {
+        AppendMessage(frame, m);
+      }
+
+      messages.clear();
+      WriteFrame(frame);
+      continue;
     }
 
-    for (size_t i = 0; i < lineQueue.size(); i++) {
-      es::Print("\033[A");
+    const bool fullRedraw =
+        !messages.empty() || newLines.size() != drawnLines.size();
+
+    if (fullRedraw) {
+      frame.append("\033[J");
+
+      for (auto &m : messages) {
+        AppendMessage(frame, m);
+      }
+
+      messages.clear();
+
+      for (auto &l : newLines) {
+        frame.append(l);
+        frame.push_back('\n');
+      }
+    } else {
+      size_t skipLines = 0;
+
+      for (size_t i = 0; i < newLines.size(); i++) {
+        if (newLines[i] == drawnLines[i]) {
+          skipLines++;
+          continue;
+        }
+
+        if (skipLines) {
+          frame.append("\033[" + std::to_string(skipLines) + "B");
+          skipLines = 0;
+        }
+
+        frame.append("\033[2K");
+        frame.append(newLines[i]);
+        frame.push_back('\n');
+      }
+
+      if (skipLines == newLines.size()) {
+        continue;
+      }
+
+      if (skipLines) {
+        frame.append("\033[" + std::to_string(skipLines) + "B");
+      }
     }
 
-    mustClear = true;
+    if (!newLines.empty()) {
+      frame.append("\033[" + std::to_string(newLines.size()) + "A");
+    }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(nextTickMS));
-    innerTick += nextTickMS;
+    WriteFrame(frame);
+    std::swap(drawnLines, newLines);
   }
 }
 
 void TerminateConsoleDontWait() {
-  pauseLogger = 2;
+  {
+    std::lock_guard<std::mutex> lg(consoleMutex);
+    stopLogger = true;
+  }
+  consoleSignal.notify_one();
+
   if (logger.joinable()) {
     logger.join();
   }
@@ -222,10 +322,14 @@ void TerminateConsoleDontWait() {
 }
 
 void InitConsole() {
+  isTTY = isatty(fileno(stdout));
 #ifdef USEWIN
-  es::Print("\033[?25l"); // Disable cursor
+  if (isTTY) {
+    es::Print("\033[?25l"); // Disable cursor
+  }
 #endif
   es::print::AddQueuer(ReceiveQueue);
+  es::print::StartAsync();
   logger = std::thread{MakeLogger};
   auto terminate = [](int sig) {
     TerminateConsoleDontWait();
@@ -238,16 +342,15 @@ void InitConsole() {
 }
 
 void TerminateConsole() {
-  while (!messageQueues[0].empty() && !messageQueues[1].empty()) {
-  }
-
+  es::print::StopAsync();
   TerminateConsoleDontWait();
 }
 
 void ConsolePrintDetail(uint8 detail) {
-  newPrintDetailSince = messageQueues[messageQueueOrder].size();
-  uint8 oldDetail = printDetail;
-  printDetail = detail | oldDetail << 4;
+  // Messages still waiting in printer queues must keep previous detail
+  es::print::WaitAsync();
+  std::lock_guard<std::mutex> lg(consoleMutex);
+  printDetail = detail;
 }
 
 static ElementAPI EAPI;
@@ -263,8 +366,10 @@ void ElementAPI::Remove(LogLine *item) {
 }
 
 void ElementAPI::Release(LogLine *line) {
-  line->PrintLine();
-  es::Print("\n");
+  ConsoleMessage msg{};
+  line->PrintLine(msg.que.payload);
+  msg.que.payload.push_back('\n');
+  messageQueue.emplace_back(std::move(msg));
   Remove(line);
 }
 
@@ -278,7 +383,10 @@ void ElementAPI::Insert(std::unique_ptr<LogLine> &&item, LogLine *where,
 }
 
 void ModifyElements_(element_callback cb) {
-  pauseLogger = true;
-  cb(EAPI);
-  pauseLogger = false;
+  {
+    auto guard = TracedLock(consoleMutex, "consoleMutex wait");
+    cb(EAPI);
+    linesChanged = true;
+  }
+  consoleSignal.notify_one();
 }
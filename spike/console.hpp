@@ -20,9 +20,11 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <string>
 
 struct LogLine {
-  virtual void PrintLine() = 0;
+  // Append line's current state into out
+  virtual void PrintLine(std::string &out) = 0;
   virtual ~LogLine() = default;
 };
 
@@ -39,25 +41,40 @@ protected:
 struct ProgressBar : CounterLine, LogLine {
   ProgressBar(es::string_view label_) : label(label_) {}
 
-  void PrintLine() override;
+  void PrintLine(std::string &out) override;
 
   void ItemCount(size_t numItems, size_t done = 0) {
     curitem = done;
+    totalItems = numItems;
+    SetDelta(numItems);
+  }
+
+  // Grows or shrinks total while keeping progress
+  // Used to replace estimated item counts with actual ones
+  void AddItemCount(int64_t numItems) {
+    SetDelta(totalItems.fetch_add(size_t(numItems),
+                                  std::memory_order_relaxed) +
+             size_t(numItems));
+  }
+
+protected:
+  std::atomic<float> itemDelta;
+  std::atomic_size_t totalItems{0};
+  es::string_view label;
+
+private:
+  void SetDelta(size_t numItems) {
     if (numItems) {
       itemDelta.store(1.f / numItems);
     } else {
       itemDelta.store(0.f);
     }
   }
-
-protected:
-  std::atomic<float> itemDelta;
-  es::string_view label;
 };
 
 struct DetailedProgressBar : ProgressBar {
   using ProgressBar::ProgressBar;
-  void PrintLine() override;
+  void PrintLine(std::string &out) override;
 
 private:
   float lastItem = 0;
@@ -66,7 +83,7 @@ private:
 struct LoadingBar : LogLine {
   LoadingBar(es::string_view payload_) : payload(payload_) {}
 
-  void PrintLine() override;
+  void PrintLine(std::string &out) override;
 
   void Finish(bool failed = false) { state = failed ? 2 : 1; }
 
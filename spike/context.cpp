@@ -224,10 +224,13 @@ APPContext::APPContext(const char *moduleName_, const std::string &appFolder_,
   if (info->mode == AppMode_e::EXTRACT) {
     assign(ExtractFile, "AppExtractFile");
     tryAssign(ExtractStat, "AppExtractStat");
+    tryAssign(ExtractStatSpan, "AppExtractStatSpan");
+    tryAssign(ExtractBuffer, "AppExtractBuffer");
   } else if (info->mode == AppMode_e::PACK) {
     assign(NewArchive, "AppNewArchive");
   } else {
     assign(ProcessFile, "AppProcessFile");
+    tryAssign(ProcessBuffer, "AppProcessBuffer");
     mainSettings.extractSettings.makeZIP = false;
     mainSettings.extractSettings.folderPerArc = false;
   }
@@ -326,6 +329,24 @@ int APPContext::ApplySetting(es::string_view key, es::string_view value) {
   }
 }
 
+void APPContext::StoreSettings(pugi::xml_node node) const {
+  ReflectorXMLUtil::SaveV2a(MainSettings(), node.append_child("common"),
+                            ReflectorXMLUtil::Flags_StringAsAttribute);
+
+  if (info->settings) {
+    ReflectorXMLUtil::SaveV2a(Settings(), node.append_child(moduleName),
+                              ReflectorXMLUtil::Flags_StringAsAttribute);
+  }
+}
+
+void APPContext::RestoreSettings(pugi::xml_node node) {
+  ReflectorXMLUtil::LoadV2(MainSettings(), node.child("common"));
+
+  if (info->settings) {
+    ReflectorXMLUtil::LoadV2(Settings(), node.child(moduleName));
+  }
+}
+
 void APPContext::PrintCLIHelp() const {
   printline("Options:" << std::endl);
 
@@ -22,6 +22,7 @@
 #include "datas/pugi_fwd.hpp"
 #include <map>
 #include <mutex>
+#include <vector>
 
 class PathFilter;
 struct reflectorStatic;
@@ -74,10 +75,15 @@ struct APPContextCopyData {
   func<decltype(AppProcessFile)> ProcessFile;
   func<decltype(AppExtractFile)> ExtractFile;
   opt_func<decltype(AppExtractStat)> ExtractStat;
+  opt_func<decltype(AppExtractStatSpan)> ExtractStatSpan;
+  opt_func<decltype(AppProcessBuffer)> ProcessBuffer;
+  opt_func<decltype(AppExtractBuffer)> ExtractBuffer;
   func<decltype(AppNewArchive)> NewArchive;
   opt_func<decltype(AppFinishContext)> FinishContext;
   const AppInfo_s *info;
 
+  bool HasExtractStat() { return ExtractStat || ExtractStatSpan; }
+
 protected:
   const char *moduleName;
   opt_func<decltype(AppInitContext)> InitContext;
@@ -115,6 +121,9 @@ struct APPContext : APPContextCopyData {
   void ResetSwitchSettings();
   void GetMarkdownDoc(std::ostream &out, pugi::xml_node node) const;
   int ApplySetting(es::string_view key, es::string_view value);
+  // Snapshot of common and module settings, used by resident server
+  void StoreSettings(pugi::xml_node node) const;
+  void RestoreSettings(pugi::xml_node node);
 
 private:
   void *dlHandle = nullptr;
@@ -155,9 +164,26 @@ struct ZIPIOContext : AppContext {
       Iter(ZIPIOEntryType = ZIPIOEntryType::String) const = 0;
   virtual std::string GetChunk(const ZipEntry &entry, size_t offset,
                                size_t size) const = 0;
+  // Entry data within mapped archive, archive is mapped on first call
+  virtual es::string_view GetView(const ZipEntry &entry) = 0;
+};
+
+// Spike side of AppContext::ExtractContext, output is created on first use
+struct OutputContext : AppContext {
+  std::function<std::unique_ptr<AppExtractContext>()> makeOutput;
+  std::unique_ptr<AppExtractContext> output;
+
+  AppExtractContext *ExtractContext() override {
+    if (!output && makeOutput) {
+      output = makeOutput();
+      output->ctx = this;
+    }
+
+    return output.get();
+  }
 };
 
-struct ZIPIOContextInstance : AppContext {
+struct ZIPIOContextInstance : OutputContext {
   ZIPIOContextInstance(ZIPIOContext *base_) : base(base_) {}
   AppContextStream RequestFile(const std::string &path) {
     return base->RequestFile(path);
@@ -172,8 +198,18 @@ private:
   ZIPIOContext *base;
 };
 
-std::unique_ptr<AppContext> MakeIOContext();
+// Overlay keys of requested files are relative to inputRoot
+std::unique_ptr<OutputContext> MakeIOContext(const std::string &inputRoot);
+// Drops memoized folder listings of FindFile/FindFiles, files on disk can
+// change between server jobs
+void ReleaseFolderIndexes();
+// Ordered ZIPs and folders, later layers win. RequestFile and FindFile of
+// every context look into merged index first, paths are relative to layer
+void MountOverlay(const std::vector<std::string> &layers);
 std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file,
                                              const PathFilter &pathFilter,
                                              const PathFilter &moduleFilter);
 std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file);
+// Nested stored ZIP, slice is entry of outer archive within same file
+std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file,
+                                             const ZipEntry &slice);
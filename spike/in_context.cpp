@@ -26,12 +26,392 @@
 #include "datas/stat.hpp"
 #include "formats/ZIP_istream.inl"
 #include "tmp_storage.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <mutex>
 #include <sstream>
 
-static std::mutex simpleIOLock;
+// Read only, seekable stream buffer over memory, no copies are made
+struct MemoryStreamBuf : std::streambuf {
+  MemoryStreamBuf(es::string_view data) {
+    char *begin = const_cast<char *>(data.data());
+    setg(begin, begin, begin + data.size());
+  }
+
+protected:
+  pos_type seekoff(off_type offset, std::ios::seekdir dir,
+                   std::ios::openmode which) override {
+    if (!(which & std::ios::in)) {
+      return pos_type(off_type(-1));
+    }
+
+    char *base = dir == std::ios::beg   ? eback()
+                 : dir == std::ios::cur ? gptr()
+                                        : egptr();
+    const off_type newPos = (base - eback()) + offset;
+
+    if (newPos < 0 || newPos > egptr() - eback()) {
+      return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + newPos, egptr());
+    return newPos;
+  }
+
+  pos_type seekpos(pos_type pos, std::ios::openmode which) override {
+    return seekoff(off_type(pos), std::ios::beg, which);
+  }
+};
+
+static std::string CanonicalPath(const std::string &path) {
+  std::error_code ec;
+  auto canonical =
+      std::filesystem::weakly_canonical(std::filesystem::u8path(path), ec);
+
+  if (ec) {
+    return path;
+  }
+
+  auto u8Path = canonical.generic_u8string();
+  return {u8Path.begin(), u8Path.end()};
+}
+
+// Process wide cache, every dependency file is mapped only once while
+// any stream uses it, mapping is released with last stream
+// Input files are expected to stay unchanged during run or server job,
+// folder listings are kept until ReleaseFolderIndexes
+struct DependencyFile {
+  std::mutex loadLock;
+  bool loaded = false;
+  es::MappedFile file;
+};
+
+struct FolderIndex {
+  std::mutex loadLock;
+  bool loaded = false;
+  DirectoryScanner::storage_type files;
+};
+
+static std::mutex dependencyCacheLock;
+static std::map<std::string, std::weak_ptr<DependencyFile>> dependencyCache;
+static std::map<std::string, std::shared_ptr<FolderIndex>> folderIndexCache;
+
+template <class item_type>
+static std::shared_ptr<item_type>
+CacheItem(std::map<std::string, std::shared_ptr<item_type>> &cache,
+          const std::string &key) {
+  auto guard = TracedLock(dependencyCacheLock, "dependencyCacheLock wait");
+  auto &item = cache[key];
+
+  if (!item) {
+    item = std::make_shared<item_type>();
+  }
+
+  return item;
+}
+
+// Evicts cache entry, unless it was already replaced by new load
+static void ReleaseDependency(const std::string &key, DependencyFile *item) {
+  {
+    auto guard = TracedLock(dependencyCacheLock, "dependencyCacheLock wait");
+    auto found = dependencyCache.find(key);
+
+    if (!es::IsEnd(dependencyCache, found) && found->second.expired()) {
+      dependencyCache.erase(found);
+    }
+  }
+
+  delete item;
+}
+
+static std::shared_ptr<DependencyFile>
+RequestDependency(const std::string &path) {
+  std::shared_ptr<DependencyFile> item;
+
+  {
+    const std::string key = CanonicalPath(path);
+    auto guard = TracedLock(dependencyCacheLock, "dependencyCacheLock wait");
+    auto &cached = dependencyCache[key];
+    item = cached.lock();
+
+    if (!item) {
+      item.reset(new DependencyFile, [key](DependencyFile *file) {
+        ReleaseDependency(key, file);
+      });
+      cached = item;
+    }
+  }
+
+  std::lock_guard<std::mutex> lg(item->loadLock);
+
+  if (!item->loaded) {
+    TraceSpan span("Load dependency", path);
+    item->file =
+        es::MappedFile(path, es::MappedFile::Mode::Read, 0, 0, false);
+    TraceBytesIn(item->file.dataSize);
+    item->loaded = true;
+  }
+
+  return item;
+}
+
+// Memoized recursive listing of folder
+static std::shared_ptr<FolderIndex> RequestFolder(const std::string &path) {
+  auto item = CacheItem(folderIndexCache, CanonicalPath(path));
+  std::lock_guard<std::mutex> lg(item->loadLock);
+
+  if (!item->loaded) {
+    TraceSpan span("Scan dependency folder", path);
+    DirectoryScanner sc;
+    sc.Scan(path);
+    item->files = sc.Files();
+    item->loaded = true;
+  }
+
+  return item;
+}
+
+void ReleaseFolderIndexes() {
+  auto guard = TracedLock(dependencyCacheLock, "dependencyCacheLock wait");
+  folderIndexCache.clear();
+}
 
-struct SimpleIOContext : AppContext {
+struct DependencyStream {
+  std::shared_ptr<DependencyFile> file;
+  MemoryStreamBuf buffer;
+  std::istream stream;
+
+  DependencyStream(std::shared_ptr<DependencyFile> &&file_)
+      : file(std::move(file_)),
+        buffer({static_cast<const char *>(file->file.data),
+                file->file.dataSize}),
+        stream(&buffer) {}
+};
+
+// Path key of overlay index, relative to layer root
+static std::string OverlayKey(es::string_view path) {
+  std::string retVal(path);
+  std::replace(retVal.begin(), retVal.end(), '\\', '/');
+
+  while (es::string_view(retVal).begins_with("./")) {
+    retVal.erase(0, 2);
+  }
+
+  const size_t firstValid = retVal.find_first_not_of('/');
+  retVal.erase(0, std::min(firstValid, retVal.size()));
+
+  return retVal;
+}
+
+// Folder prefix of overlay index keys, empty for layer root
+static std::string OverlayFolderKey(es::string_view folder) {
+  std::string retVal = OverlayKey(folder);
+
+  if (!retVal.empty() && retVal.back() != '/') {
+    retVal.push_back('/');
+  }
+
+  return retVal;
+}
+
+// Merged index of ZIP and folder layers, later layers win
+// Served before context of processed file, so patched files are preferred
+struct OverlayVFS {
+  struct Entry {
+    ZIPIOContext *zip = nullptr;
+    ZipEntry zipEntry{};
+    std::string filePath;
+  };
+
+  std::vector<std::unique_ptr<ZIPIOContext>> zips;
+  std::map<std::string, Entry> index;
+  // File name to every index key with that name, used by FindFile
+  std::map<std::string, std::vector<const std::string *>, std::less<>> names;
+  std::mutex openedFilesLock;
+  // Folder layer streams own their data, ZIP layer streams are disposed
+  // through their context
+  std::map<std::istream *, std::unique_ptr<DependencyStream>> openedFiles;
+  std::map<std::istream *, ZIPIOContext *> openedZIPFiles;
+
+  void AddLayer(const std::string &path);
+  void IndexNames();
+  std::istream *Open(const Entry &entry);
+  bool Dispose(std::istream *str);
+};
+
+static std::unique_ptr<OverlayVFS> overlayVFS;
+
+void OverlayVFS::AddLayer(const std::string &path) {
+  TraceSpan span("Load overlay layer", path);
+
+  if (FileType(path) == FileType_e::Directory) {
+    DirectoryScanner sc;
+    sc.Scan(path);
+
+    for (auto &f : sc) {
+      es::string_view relPath(f);
+      relPath.remove_prefix(std::min(path.size(), relPath.size()));
+      Entry entry;
+      entry.filePath = f;
+      index.insert_or_assign(OverlayKey(relPath), std::move(entry));
+    }
+
+    return;
+  }
+
+  auto &zip = zips.emplace_back(MakeZIPContext(path));
+  auto vfsIter = zip->Iter();
+
+  for (auto f : vfsIter) {
+    Entry entry;
+    entry.zip = zip.get();
+    entry.zipEntry = f;
+    index.insert_or_assign(OverlayKey(f.AsView()), std::move(entry));
+  }
+}
+
+void OverlayVFS::IndexNames() {
+  names.clear();
+
+  for (auto &[path, _] : index) {
+    es::string_view fileName(path);
+
+    if (size_t lastSlash = fileName.find_last_of('/');
+        lastSlash != fileName.npos) {
+      fileName.remove_prefix(lastSlash + 1);
+    }
+
+    names[fileName.to_string()].push_back(&path);
+  }
+}
+
+std::istream *OverlayVFS::Open(const Entry &entry) {
+  if (entry.zip) {
+    std::istream *ptr = entry.zip->OpenFile(entry.zipEntry);
+    std::lock_guard<std::mutex> lg(openedFilesLock);
+    openedZIPFiles.emplace(ptr, entry.zip);
+    return ptr;
+  }
+
+  auto opened =
+      std::make_unique<DependencyStream>(RequestDependency(entry.filePath));
+  std::istream *ptr = &opened->stream;
+  std::lock_guard<std::mutex> lg(openedFilesLock);
+  openedFiles.emplace(ptr, std::move(opened));
+  return ptr;
+}
+
+bool OverlayVFS::Dispose(std::istream *str) {
+  ZIPIOContext *zip = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lg(openedFilesLock);
+
+    if (openedFiles.erase(str)) {
+      return true;
+    }
+
+    auto found = openedZIPFiles.find(str);
+
+    if (es::IsEnd(openedZIPFiles, found)) {
+      return false;
+    }
+
+    zip = found->second;
+    openedZIPFiles.erase(found);
+  }
+
+  zip->DisposeFile(str);
+  return true;
+}
+
+void MountOverlay(const std::vector<std::string> &layers) {
+  auto vfs = std::make_unique<OverlayVFS>();
+
+  for (auto &l : layers) {
+    vfs->AddLayer(l);
+  }
+
+  vfs->IndexNames();
+
+  printinfo("Overlay mounted, files: " << vfs->index.size());
+  overlayVFS = std::move(vfs);
+}
+
+static std::istream *OverlayRequestFile(const std::string &path) {
+  if (!overlayVFS) {
+    return nullptr;
+  }
+
+  auto found = overlayVFS->index.find(OverlayKey(path));
+
+  if (es::IsEnd(overlayVFS->index, found)) {
+    return nullptr;
+  }
+
+  return overlayVFS->Open(found->second);
+}
+
+// Returns only file within folderKey which name matches pattern
+// Names with fixed beginning are looked up by prefix
+static std::istream *OverlayFindFile(const std::string &folderKey,
+                                     const std::string &pattern,
+                                     std::string &foundPath) {
+  if (!overlayVFS) {
+    return nullptr;
+  }
+
+  PathFilter filter;
+  filter.AddFilter(pattern);
+  auto &names = overlayVFS->names;
+  auto begin = names.begin();
+  es::string_view prefix;
+
+  if (es::string_view pat(pattern); pat.begins_with("^")) {
+    pat.remove_prefix(1);
+    prefix = pat.substr(0, pat.find_first_of("*$"));
+    begin = names.lower_bound(prefix);
+  }
+
+  const std::string *found = nullptr;
+
+  for (auto it = begin; it != names.end(); it++) {
+    if (!es::string_view(it->first).begins_with(prefix)) {
+      break;
+    }
+
+    if (!filter.IsFiltered(it->first)) {
+      continue;
+    }
+
+    for (auto path : it->second) {
+      if (!es::string_view(*path).begins_with(folderKey)) {
+        continue;
+      }
+
+      if (found) {
+        throw std::runtime_error("Too many files found.");
+      }
+
+      found = path;
+    }
+  }
+
+  if (!found) {
+    return nullptr;
+  }
+
+  foundPath = *found;
+  return overlayVFS->Open(overlayVFS->index.at(*found));
+}
+
+static bool OverlayDisposeFile(std::istream *str) {
+  return overlayVFS && overlayVFS->Dispose(str);
+}
+
+struct SimpleIOContext : OutputContext {
+  SimpleIOContext(const std::string &inputRoot_) : inputRoot(inputRoot_) {}
   std::istream *OpenFile(const std::string &path);
 
   AppContextStream RequestFile(const std::string &path) override;
@@ -42,8 +422,20 @@ struct SimpleIOContext : AppContext {
   void DisposeFile(std::istream *str) override;
 
 private:
-  BinReader streamedFiles[32];
-  uint32 usedFiles = 0;
+  // Overlay keys are relative to it
+  std::string inputRoot;
+  std::mutex openedFilesLock;
+  std::map<std::istream *, std::unique_ptr<DependencyStream>> openedFiles;
+
+  bool InputKey(es::string_view path, std::string &key) const {
+    if (!path.begins_with(inputRoot)) {
+      return false;
+    }
+
+    path.remove_prefix(inputRoot.size());
+    key = path;
+    return true;
+  }
 };
 
 struct ZIPContext : AppContext {
@@ -56,65 +448,81 @@ struct ZIPContext : AppContext {
 };
 
 std::istream *SimpleIOContext::OpenFile(const std::string &path) {
-  std::lock_guard<std::mutex> guard(simpleIOLock);
-  for (size_t b = 0; b < 32; b++) {
-    uint32 bit = 1 << b;
-    if (!(usedFiles & bit)) {
-      streamedFiles[b].Open(path);
-      usedFiles ^= bit;
-      return &streamedFiles[b].BaseStream();
-    }
-  }
-
-  throw std::out_of_range("Maximum opened files reached!");
+  auto opened = std::make_unique<DependencyStream>(RequestDependency(path));
+  std::istream *ptr = &opened->stream;
+  std::lock_guard<std::mutex> lg(openedFilesLock);
+  openedFiles.emplace(ptr, std::move(opened));
+  return ptr;
 }
 
 AppContextStream SimpleIOContext::RequestFile(const std::string &path) {
   AFileInfo wFile(workingFile);
   AFileInfo pFile(path);
   auto catchedFile = pFile.CatchBranch(wFile.GetFolder());
+
+  if (std::string key; InputKey(catchedFile, key)) {
+    if (auto overlayFile = OverlayRequestFile(key)) {
+      return {overlayFile, this};
+    }
+  }
+
   return {OpenFile(catchedFile), this};
 }
 
 AppContextFoundStream SimpleIOContext::FindFile(const std::string &rootFolder,
                                                 const std::string &pattern) {
-  DirectoryScanner sc;
-  sc.AddFilter(pattern);
-  sc.Scan(rootFolder);
+  if (std::string key; InputKey(rootFolder + '/', key)) {
+    std::string foundPath;
 
-  if (sc.Files().empty()) {
-    throw es::FileNotFoundError(pattern);
-  } else if (sc.Files().size() > 1) {
-    throw std::runtime_error("Too many files found.");
+    if (auto overlayFile =
+            OverlayFindFile(OverlayFolderKey(key), pattern, foundPath)) {
+      return {overlayFile, this, foundPath};
+    }
   }
 
-  return {OpenFile(sc.Files().front()), this, sc.Files().front()};
-}
+  auto folder = RequestFolder(rootFolder);
+  PathFilter filter;
+  filter.AddFilter(pattern);
+  const std::string *foundFile = nullptr;
 
-void SimpleIOContext::DisposeFile(std::istream *str) {
-  size_t index = 0;
+  for (auto &f : folder->files) {
+    es::string_view fileName(f);
 
-  for (auto &f : streamedFiles) {
-    if (&f.BaseStream() == str) {
-      uint32 bit = 1 << index;
+    if (size_t lastSlash = fileName.find_last_of('/');
+        lastSlash != fileName.npos) {
+      fileName.remove_prefix(lastSlash + 1);
+    }
 
-      if (!(usedFiles & bit)) {
-        throw std::runtime_error("Stream already freed.");
+    if (filter.IsFiltered(fileName)) {
+      if (foundFile) {
+        throw std::runtime_error("Too many files found.");
       }
 
-      es::Dispose(f);
-      usedFiles ^= bit;
-      return;
+      foundFile = &f;
     }
+  }
 
-    index++;
+  if (!foundFile) {
+    throw es::FileNotFoundError(pattern);
+  }
+
+  return {OpenFile(*foundFile), this, *foundFile};
+}
+
+void SimpleIOContext::DisposeFile(std::istream *str) {
+  if (OverlayDisposeFile(str)) {
+    return;
   }
 
-  throw std::runtime_error("Requested stream not found!");
+  std::lock_guard<std::mutex> lg(openedFilesLock);
+
+  if (!openedFiles.erase(str)) {
+    throw std::runtime_error("Requested stream not found!");
+  }
 }
 
-std::unique_ptr<AppContext> MakeIOContext() {
-  return std::make_unique<SimpleIOContext>();
+std::unique_ptr<OutputContext> MakeIOContext(const std::string &inputRoot) {
+  return std::make_unique<SimpleIOContext>(inputRoot);
 }
 
 static std::mutex ZIPLock;
@@ -124,15 +532,19 @@ struct ZIPDataHolder {
 };
 
 struct ZIPIOContext_implbase : ZIPIOContext {
-  ZIPIOContext_implbase(const std::string &file) : rd(file) {}
+  ZIPIOContext_implbase(const std::string &file) : rd(file), path(file) {}
   std::istream *OpenFile(const ZipEntry &entry) override;
   std::string GetChunk(const ZipEntry &entry, size_t offset,
                        size_t size) const override;
+  es::string_view GetView(const ZipEntry &entry) override;
   void DisposeFile(std::istream *str) override;
 
 protected:
   std::map<std::istream *, std::unique_ptr<ZIPDataHolder>> openedFiles;
   BinReader rd;
+  std::string path;
+  es::MappedFile mappedArchive;
+  std::once_flag mapArchiveFlag;
 };
 
 struct ZIPMemoryStream : ZIPDataHolder {
@@ -157,7 +569,7 @@ struct ZIPFileStream : ZIPDataHolder {
 };
 
 std::istream *ZIPIOContext_implbase::OpenFile(const ZipEntry &entry) {
-  std::lock_guard<std::mutex> guard(ZIPLock);
+  auto guard = TracedLock(ZIPLock, "Input ZIPLock wait");
   rd.Seek(entry.offset);
   constexpr size_t memoryLimit = 16777216;
 
@@ -197,15 +609,34 @@ std::istream *ZIPIOContext_implbase::OpenFile(const ZipEntry &entry) {
 
 std::string ZIPIOContext_implbase::GetChunk(const ZipEntry &entry,
                                             size_t offset, size_t size) const {
-  std::lock_guard<std::mutex> guard(ZIPLock);
+  auto guard = TracedLock(ZIPLock, "Input ZIPLock wait");
   rd.Seek(entry.offset + offset);
   std::string retVal;
   rd.ReadContainer(retVal, size);
   return retVal;
 }
 
+es::string_view ZIPIOContext_implbase::GetView(const ZipEntry &entry) {
+  std::call_once(mapArchiveFlag, [&] {
+    mappedArchive =
+        es::MappedFile(path, es::MappedFile::Mode::Read, 0, 0, false);
+    mappedArchive.Advise(es::MappedFile::Access::Random);
+  });
+
+  if (entry.offset + entry.size > mappedArchive.dataSize) {
+    throw std::out_of_range("ZIP entry is out of archive bounds.");
+  }
+
+  return {static_cast<const char *>(mappedArchive.data) + entry.offset,
+          entry.size};
+}
+
 void ZIPIOContext_implbase::DisposeFile(std::istream *str) {
-  std::lock_guard<std::mutex> guard(ZIPLock);
+  if (OverlayDisposeFile(str)) {
+    return;
+  }
+
+  auto guard = TracedLock(ZIPLock, "Input ZIPLock wait");
   openedFiles.erase(str);
 }
 
@@ -251,23 +682,34 @@ struct ZIPIOContext_impl : ZIPIOContext_implbase {
                     const PathFilter &moduleFilter_)
       : ZIPIOContext_implbase(file), pathFilter(&pathFilter_),
         moduleFilter(&moduleFilter_) {
-    Read();
+    Read(rd.GetSize());
     pathFilter = moduleFilter = nullptr;
   }
 
   ZIPIOContext_impl(const std::string &file) : ZIPIOContext_implbase(file) {
-    Read();
+    Read(rd.GetSize());
+  }
+
+  // Stored ZIP within entry of outer archive, entries keep file offsets
+  ZIPIOContext_impl(const std::string &file, const ZipEntry &slice)
+      : ZIPIOContext_implbase(file) {
+    rd.Seek(slice.offset);
+    Read(slice.offset + slice.size);
   }
 
 private:
   void ReadEntry();
-  void Read();
+  void Read(size_t end);
   const PathFilter *pathFilter = nullptr;
   const PathFilter *moduleFilter = nullptr;
   std::map<std::string, ZipEntry> vfs;
 };
 
 AppContextStream ZIPIOContext_impl::RequestFile(const std::string &path) {
+  if (auto overlayFile = OverlayRequestFile(path)) {
+    return {overlayFile, this};
+  }
+
   auto found = vfs.find(path);
 
   if (es::IsEnd(vfs, found)) {
@@ -277,8 +719,15 @@ AppContextStream ZIPIOContext_impl::RequestFile(const std::string &path) {
   return {OpenFile(found->second), this};
 }
 
-AppContextFoundStream ZIPIOContext_impl::FindFile(const std::string &,
-                                                  const std::string &pattern) {
+AppContextFoundStream
+ZIPIOContext_impl::FindFile(const std::string &rootFolder,
+                            const std::string &pattern) {
+  if (std::string foundPath;
+      auto overlayFile =
+          OverlayFindFile(OverlayFolderKey(rootFolder), pattern, foundPath)) {
+    return {overlayFile, this, foundPath};
+  }
+
   PathFilter filter;
   filter.AddFilter(pattern);
 
@@ -295,9 +744,8 @@ AppContextFoundStream ZIPIOContext_impl::FindFile(const std::string &,
   throw es::FileNotFoundError(pattern);
 }
 
-void ZIPIOContext_impl::Read() {
-  const size_t fileSize = rd.GetSize();
-  while (rd.Tell() < fileSize) {
+void ZIPIOContext_impl::Read(size_t end) {
+  while (rd.Tell() < end) {
     ReadEntry();
   }
 }
@@ -425,6 +873,9 @@ ZIPIOEntry::operator bool() const {
 
 struct ZIPIOContextCached : ZIPIOContext_implbase {
   AppContextStream RequestFile(const std::string &path) override {
+    if (auto overlayFile = OverlayRequestFile(path)) {
+      return {overlayFile, this};
+    }
 
     auto found = cache.RequestFile(path);
 
@@ -435,8 +886,14 @@ struct ZIPIOContextCached : ZIPIOContext_implbase {
     return {OpenFile(found), this};
   }
 
-  AppContextFoundStream FindFile(const std::string &,
+  AppContextFoundStream FindFile(const std::string &rootFolder,
                                  const std::string &pattern) override {
+    if (std::string foundPath;
+        auto overlayFile = OverlayFindFile(OverlayFolderKey(rootFolder),
+                                           pattern, foundPath)) {
+      return {overlayFile, this, foundPath};
+    }
+
     auto found = cache.FindFile(pattern);
 
     if (!found.size) {
@@ -479,6 +936,11 @@ std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file,
   return std::make_unique<ZIPIOContext_impl>(file, pathFilter, moduleFilter);
 }
 
+std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file,
+                                             const ZipEntry &slice) {
+  return std::make_unique<ZIPIOContext_impl>(file, slice);
+}
+
 std::unique_ptr<ZIPIOContext> MakeZIPContext(const std::string &file) {
   std::string cacheFile = file + ".cache";
   es::MappedFile mf;
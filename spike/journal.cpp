@@ -0,0 +1,207 @@
+/*  Spike is universal dedicated module handler
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "journal.hpp"
+#include "cache.hpp"
+#include "datas/binreader.hpp"
+#include "datas/binwritter.hpp"
+#include "datas/master_printer.hpp"
+#include "datas/stat.hpp"
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+static struct {
+  std::mutex lock;
+  BinWritter_t<BinCoreOpenMode::Append | BinCoreOpenMode::Text> writer;
+  bool active = false;
+  std::set<std::string> done;
+  std::map<std::string, size_t> mergedSizes;
+  std::set<std::string> finished;
+  // Keys merged into zip, they are lost together with zip
+  std::map<std::string, std::vector<std::string>> zipKeys;
+} journal;
+
+static void ForgetZIP(const std::string &zip) {
+  if (auto found = journal.zipKeys.find(zip); found != journal.zipKeys.end()) {
+    for (auto &k : found->second) {
+      journal.done.erase(k);
+    }
+
+    journal.zipKeys.erase(found);
+  }
+
+  journal.mergedSizes.erase(zip);
+  journal.finished.erase(zip);
+}
+
+// Invalid zip is started over, keys merged into it are processed again
+static void ResetZIP(const std::string &zip) {
+  ForgetZIP(zip);
+
+  if (!journal.active) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lg(journal.lock);
+  journal.writer.BaseStream() << "R\t" << zip << std::endl;
+}
+
+void StartJournal(const std::string &path) {
+  if (FileType(path) == FileType_e::File) {
+    BinReader_t<BinCoreOpenMode::Text> rd(path);
+    std::string line;
+
+    while (std::getline(rd.BaseStream(), line)) {
+      // Line without newline was cut by crash
+      if (rd.BaseStream().eof()) {
+        break;
+      }
+
+      es::string_view sv(line);
+      auto NextField = [&] {
+        const size_t tab = sv.find('\t');
+        auto retVal = sv.substr(0, tab);
+        sv.remove_prefix(tab == sv.npos ? sv.size() : tab + 1);
+        return retVal;
+      };
+
+      const auto type = NextField();
+
+      if (type == "D") {
+        journal.done.emplace(sv);
+      } else if (type == "M") {
+        std::string zip(NextField());
+        const size_t size = std::strtoull(NextField().to_string().c_str(),
+                                          nullptr, 10);
+        auto &mergedSize = journal.mergedSizes[zip];
+        mergedSize = std::max(mergedSize, size);
+        journal.done.emplace(sv);
+        journal.zipKeys[zip].emplace_back(sv);
+        journal.finished.erase(zip);
+      } else if (type == "F") {
+        journal.finished.emplace(sv);
+        journal.mergedSizes.erase(sv.to_string());
+      } else if (type == "R") {
+        ForgetZIP(sv.to_string());
+      }
+    }
+
+    printinfo("Resuming from journal: " << path << ", finished inputs: "
+                                        << journal.done.size());
+  }
+
+  journal.writer.Open(path);
+  journal.active = true;
+}
+
+bool JournalActive() { return journal.active; }
+
+bool IsJournaledDone(const std::string &key) {
+  return journal.done.count(key);
+}
+
+size_t JournaledZIPSize(const std::string &zip) {
+  auto found = journal.mergedSizes.find(zip);
+
+  if (found == journal.mergedSizes.end()) {
+    return 0;
+  }
+
+  const size_t size = found->second;
+
+  try {
+    if (FileType(zip) == FileType_e::File &&
+        BinReader(zip).GetSize() >= size) {
+      return size;
+    }
+  } catch (const std::exception &) {
+  }
+
+  printwarning("Journaled part of " << zip << " is missing, starting over.");
+  ResetZIP(zip);
+
+  return 0;
+}
+
+static bool IsValidFinishedZIP(const std::string &zip) {
+  try {
+    BinReader cacheRd(zip + ".cache");
+    CacheBaseHeader cacheHdr;
+    cacheRd.Read(cacheHdr);
+    BinReader zipRd(zip);
+
+    if (cacheHdr.id != CacheBaseHeader::ID ||
+        zipRd.GetSize() != cacheHdr.zipSize) {
+      return false;
+    }
+
+    zipRd.Seek(cacheHdr.zipCheckupOffset);
+    CacheBaseHeader zipHdr;
+    zipRd.Read(zipHdr);
+
+    return !memcmp(&zipHdr, &cacheHdr, sizeof(zipHdr));
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+bool IsJournaledFinished(const std::string &zip) {
+  if (!journal.finished.count(zip)) {
+    return false;
+  }
+
+  if (IsValidFinishedZIP(zip)) {
+    return true;
+  }
+
+  printwarning("Finished " << zip << " is invalid, starting over.");
+  ResetZIP(zip);
+
+  return false;
+}
+
+void JournalDone(es::string_view key) {
+  if (!journal.active) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lg(journal.lock);
+  journal.writer.BaseStream() << "D\t" << key << std::endl;
+}
+
+void JournalMerged(const std::string &zip, size_t size, es::string_view key) {
+  if (!journal.active) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lg(journal.lock);
+  journal.writer.BaseStream() << "M\t" << zip << '\t' << size << '\t' << key
+                              << std::endl;
+}
+
+void JournalFinished(const std::string &zip) {
+  if (!journal.active) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lg(journal.lock);
+  journal.writer.BaseStream() << "F\t" << zip << std::endl;
+}
@@ -0,0 +1,40 @@
+/*  Spike is universal dedicated module handler
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "datas/string_view.hpp"
+#include <string>
+
+// Append-only journal of finished work for spike --resume
+// Lines are tab separated:
+//   D key             input (file or ZIP entry) is finished
+//   M zip size key    key was merged into zip, zip is valid up to size
+//   F zip             zip was finished
+//   R zip             zip was invalid, its merged keys are not finished
+void StartJournal(const std::string &path);
+bool JournalActive();
+bool IsJournaledDone(const std::string &key);
+// Size of unfinished zip covered by journal, 0 when there is none
+// Missing or truncated zip is reset
+size_t JournaledZIPSize(const std::string &zip);
+// Finished zip, validated by cache checkup header
+// Invalid zip is reset
+bool IsJournaledFinished(const std::string &zip);
+void JournalDone(es::string_view key);
+void JournalMerged(const std::string &zip, size_t size, es::string_view key);
+void JournalFinished(const std::string &zip);
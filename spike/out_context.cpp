@@ -25,9 +25,113 @@
 #include "datas/stat.hpp"
 #include "formats/ZIP_istream.inl"
 #include "formats/ZIP_ostream.inl"
+#include "journal.hpp"
+#include "trace.hpp"
 #include <chrono>
+#include <filesystem>
 #include <mutex>
 
+AsyncDataSink::~AsyncDataSink() {
+  {
+    std::lock_guard<std::mutex> lg(mtx);
+    stop = true;
+  }
+
+  signal.notify_all();
+
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void AsyncDataSink::Worker() {
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (true) {
+    signal.wait(lock, [&] { return stop || !queue.empty(); });
+
+    if (queue.empty()) {
+      return;
+    }
+
+    Job job = std::move(queue.front());
+    queue.pop_front();
+    busy = true;
+    lock.unlock();
+    signal.notify_all();
+
+    std::exception_ptr jobError;
+
+    try {
+      for (auto &b : job.blocks) {
+        job.write(b);
+      }
+    } catch (...) {
+      jobError = std::current_exception();
+    }
+
+    job = {};
+    lock.lock();
+    busy = false;
+
+    if (jobError && !error) {
+      error = jobError;
+    }
+
+    signal.notify_all();
+  }
+}
+
+void AsyncDataSink::Wait() {
+  std::unique_lock<std::mutex> lock(mtx);
+  signal.wait(lock, [&] { return queue.empty() && !busy; });
+
+  if (error) {
+    std::exception_ptr curError = error;
+    error = nullptr;
+    std::rethrow_exception(curError);
+  }
+}
+
+void AsyncDataSink::Send(const es::string_view *buffers, size_t numBuffers,
+                         std::unique_ptr<AppDataOwner> owner,
+                         write_type write) {
+  size_t totalSize = 0;
+
+  for (size_t b = 0; b < numBuffers; b++) {
+    totalSize += buffers[b].size();
+  }
+
+  if (!owner || totalSize < ASYNC_THRESHOLD) {
+    Wait();
+
+    for (size_t b = 0; b < numBuffers; b++) {
+      write(buffers[b]);
+    }
+
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mtx);
+  signal.wait(lock, [&] { return queue.size() < MAX_QUEUED || error; });
+
+  if (error) {
+    std::exception_ptr curError = error;
+    error = nullptr;
+    std::rethrow_exception(curError);
+  }
+
+  queue.push_back(Job{std::move(owner), {buffers, buffers + numBuffers},
+                      std::move(write)});
+
+  if (!worker.joinable()) {
+    worker = std::thread(&AsyncDataSink::Worker, this);
+  }
+
+  lock.unlock();
+  signal.notify_all();
+}
+
 void ZIPExtactContext::FinishZIP(cache_begin_cb cacheBeginCB) {
   FinishFile(true);
 
@@ -84,6 +188,7 @@ void ZIPExtactContext::FinishZIP(cache_begin_cb cacheBeginCB) {
     ZIP64CentralDirLocator zLoca{};
     zLoca.id = ZIP64CentralDirLocator::ID;
     zLoca.centralDirOffset = centralOffset;
+    zLoca.numDisks = 1;
     records.Write(zLoca);
   }
 
@@ -100,6 +205,7 @@ void ZIPExtactContext::FinishZIP(cache_begin_cb cacheBeginCB) {
 }
 
 void ZIPExtactContext::FinishFile(bool final) {
+  sink.Wait();
   auto SafeCast = [&](auto &where, auto &&what) {
     const uint64 limit =
         std::numeric_limits<std::decay_t<decltype(where)>>::max();
@@ -200,6 +306,7 @@ inline std::tm localtime(std::time_t t) {
 }
 
 void ZIPExtactContext::NewFile(const std::string &path) {
+  sink.Wait();
   AFileInfo pathInfo(path);
   auto pathSv = pathInfo.GetFullPath();
   if (!curFileName.empty()) {
@@ -240,12 +347,30 @@ void ZIPExtactContext::NewFile(const std::string &path) {
   }
 }
 
-void ZIPExtactContext::SendData(es::string_view data) {
-  curFileSize += data.size();
+void ZIPExtactContext::WriteData(es::string_view data) {
   zLocalFile.crc = crc32b(zLocalFile.crc, data.data(), data.size());
   records.WriteContainer(data);
 }
 
+void ZIPExtactContext::SendData(es::string_view data) {
+  sink.Wait();
+  TraceBytesOut(data.size());
+  curFileSize += data.size();
+  WriteData(data);
+}
+
+void ZIPExtactContext::SendBuffers(const es::string_view *buffers,
+                                   size_t numBuffers,
+                                   std::unique_ptr<AppDataOwner> owner) {
+  for (size_t b = 0; b < numBuffers; b++) {
+    TraceBytesOut(buffers[b].size());
+    curFileSize += buffers[b].size();
+  }
+
+  sink.Send(buffers, numBuffers, std::move(owner),
+            [this](es::string_view data) { WriteData(data); });
+}
+
 bool ZIPExtactContext::RequiresFolders() const { return false; }
 
 void ZIPExtactContext::AddFolderPath(const std::string &) {
@@ -259,6 +384,7 @@ void ZIPExtactContext::GenerateFolders() {
 }
 
 void IOExtractContext::NewFile(const std::string &path) {
+  sink.Wait();
   Close_();
   AFileInfo cfleWrap(path);
   auto cfle = cfleWrap.GetFullPath();
@@ -272,7 +398,22 @@ void IOExtractContext::NewFile(const std::string &path) {
   }
 }
 
-void IOExtractContext::SendData(es::string_view data) { WriteContainer(data); }
+void IOExtractContext::SendData(es::string_view data) {
+  sink.Wait();
+  TraceBytesOut(data.size());
+  WriteContainer(data);
+}
+
+void IOExtractContext::SendBuffers(const es::string_view *buffers,
+                                   size_t numBuffers,
+                                   std::unique_ptr<AppDataOwner> owner) {
+  for (size_t b = 0; b < numBuffers; b++) {
+    TraceBytesOut(buffers[b].size());
+  }
+
+  sink.Send(buffers, numBuffers, std::move(owner),
+            [this](es::string_view data) { WriteContainer(data); });
+}
 
 bool IOExtractContext::RequiresFolders() const { return true; }
 
@@ -300,14 +441,17 @@ void IOExtractContext::GenerateFolders() {
 
 static std::mutex ZIPLock;
 
-void ZIPMerger::Merge(ZIPExtactContext &other, const std::string &recordsFile) {
+void ZIPMerger::Merge(ZIPExtactContext &other, const std::string &recordsFile,
+                      es::string_view journalKey) {
+  other.sink.Wait();
+
   if (!other.curFileName.empty()) {
     other.FinishFile();
   }
 
   BinReaderRef localEntries(other.entriesStream);
   char buffer[0x80000];
-  std::lock_guard<std::mutex> guard(ZIPLock);
+  auto guard = TracedLock(ZIPLock, "Output ZIPLock wait");
   const size_t filesSize = records.Tell();
 
   numEntries += other.numEntries;
@@ -388,6 +532,257 @@ void ZIPMerger::Merge(ZIPExtactContext &other, const std::string &recordsFile) {
     rd.ReadBuffer(buffer, restBytes);
     records.WriteBuffer(buffer, restBytes);
   }
+
+  // Journaled under lock, so journaled sizes always cover merged keys
+  if (!journalKey.empty()) {
+    records.BaseStream().flush();
+    JournalMerged(outFile, records.Tell(), journalKey);
+  }
+}
+
+void ZIPMerger::AppendEntry(ZIPFile zFile, const std::string &fileName,
+                            uint64 localHeaderOffset, uint64 fileSize,
+                            uint64 fileDataBegin) {
+  const bool useSizes = fileSize >= 0xffffffff;
+  const bool useOffset = localHeaderOffset >= 0xffffffff;
+  ZIP64Extra extra;
+  zFile.extraFieldSize = 0;
+  zFile.fileCommentSize = 0;
+  zFile.localHeaderOffset = localHeaderOffset;
+
+  if (useSizes || useOffset) {
+    zFile.extraFieldSize = 4;
+
+    if (useSizes) {
+      extra.uncompressedSize = fileSize;
+      extra.compressedSize = fileSize;
+      zFile.extraFieldSize += 16;
+    }
+
+    if (useOffset) {
+      extra.localHeaderOffset = localHeaderOffset;
+      zFile.localHeaderOffset = 0xffffffff;
+      zFile.extraFieldSize += 8;
+    }
+  }
+
+  entries.Write(zFile);
+  entries.WriteContainer(fileName);
+
+  if (zFile.extraFieldSize) {
+    entries.Write(extra);
+  }
+
+  cache.AddFile(fileName, fileDataBegin, fileSize);
+  cache.meta.zipCRC = crc32b(cache.meta.zipCRC,
+                             reinterpret_cast<const char *>(&zFile.crc), 4);
+  numEntries++;
+}
+
+ZIPMerger::ZIPMerger(const std::string &outFiles,
+                     const std::string &outEntries, size_t resumeSize)
+    : entries(outEntries), entriesFile(outEntries), outFile(outFiles) {
+  if (resumeSize) {
+    // Anything past journaled size is from unjournaled merge
+    std::filesystem::resize_file(std::filesystem::u8path(outFiles),
+                                 resumeSize);
+    ResumeArchive(resumeSize);
+  } else {
+    // Records only continue existing file
+    BinWritter create(outFiles);
+  }
+
+  records.Open(outFiles);
+}
+
+void ZIPMerger::ResumeArchive(size_t validSize) {
+  BinReader rd(outFile);
+
+  // Only local records are present, central entries are made from them
+  while (rd.Tell() < validSize) {
+    const size_t localHeaderOffset = rd.Tell();
+    ZIPLocalFile zLocalFile;
+    rd.Read(zLocalFile);
+
+    if (zLocalFile.id != ZIPLocalFile::ID) {
+      throw std::runtime_error("Invalid local entry in partial ZIP: " +
+                               outFile);
+    }
+
+    std::string fileName;
+    fileName.resize(zLocalFile.fileNameSize);
+    rd.ReadBuffer(fileName.data(), fileName.size());
+    uint64 fileSize = zLocalFile.uncompressedSize;
+
+    if (zLocalFile.uncompressedSize == 0xffffffff) {
+      rd.Push();
+      const size_t extraEnd = rd.Tell() + zLocalFile.extraFieldSize;
+
+      while (rd.Tell() + 4 <= extraEnd) {
+        uint16 extraId;
+        uint16 extraSize;
+        rd.Read(extraId);
+        rd.Read(extraSize);
+
+        if (extraId == 1) {
+          rd.Read(fileSize);
+          break;
+        }
+
+        rd.Skip(extraSize);
+      }
+
+      rd.Pop();
+    }
+
+    rd.Skip(zLocalFile.extraFieldSize);
+    const size_t fileDataBegin = rd.Tell();
+    rd.Skip(fileSize);
+
+    ZIPFile zFile{};
+    zFile.id = ZIPFile::ID;
+    zFile.madeBy = 10;
+    zFile.extractVersion = zLocalFile.extractVersion;
+    zFile.flags = zLocalFile.flags;
+    zFile.compression = zLocalFile.compression;
+    zFile.lastModFileTime = zLocalFile.lastModFileTime;
+    zFile.lastModFileDate = zLocalFile.lastModFileDate;
+    zFile.crc = zLocalFile.crc;
+    zFile.compressedSize = zLocalFile.compressedSize;
+    zFile.uncompressedSize = zLocalFile.uncompressedSize;
+    zFile.fileNameSize = zLocalFile.fileNameSize;
+
+    AppendEntry(zFile, fileName, localHeaderOffset, fileSize, fileDataBegin);
+  }
+
+  if (rd.Tell() != validSize) {
+    throw std::runtime_error("Journaled size splits local entry: " + outFile);
+  }
+}
+
+void ZIPMerger::MergeArchive(const std::string &zipFile) {
+  BinReader rd(zipFile);
+  const size_t zipSize = rd.GetSize();
+  char buffer[0x80000];
+
+  // Central dir end might be followed by comment
+  const size_t searchSize = std::min(zipSize, size_t(0x10000 + 22));
+  rd.Seek(zipSize - searchSize);
+  rd.ReadBuffer(buffer, searchSize);
+  const size_t foundCentral =
+      std::string_view(buffer, searchSize).rfind("PK\x05\x06");
+
+  if (foundCentral == std::string_view::npos) {
+    throw std::runtime_error("Couldn't find ZIP central directory: " + zipFile);
+  }
+
+  const size_t centralOffset = zipSize - searchSize + foundCentral;
+  rd.Seek(centralOffset);
+  ZIPCentralDir zCentral;
+  rd.Read(zCentral);
+  uint64 numArcEntries = zCentral.numDirEntries;
+  uint64 dirOffset = zCentral.dirOffset;
+  size_t dirEnd = centralOffset;
+
+  if (centralOffset >= 20) {
+    rd.Seek(centralOffset - 20);
+    uint32 locatorId;
+    rd.Read(locatorId);
+
+    if (locatorId == ZIP64CentralDirLocator::ID) {
+      rd.Skip(-4);
+      ZIP64CentralDirLocator zLoca;
+      rd.Read(zLoca);
+      rd.Seek(zLoca.centralDirOffset);
+      ZIP64CentralDir zCentral64;
+      rd.Read(zCentral64);
+      numArcEntries = zCentral64.numDirEntries;
+      dirOffset = zCentral64.dirOffset;
+      dirEnd = zLoca.centralDirOffset;
+    }
+  }
+
+  if (dirOffset > dirEnd) {
+    throw std::runtime_error("Invalid ZIP central directory: " + zipFile);
+  }
+
+  const size_t filesSize = records.Tell();
+  rd.Seek(dirOffset);
+
+  for (uint64 e = 0; e < numArcEntries; e++) {
+    ZIPFile zFile;
+    rd.Read(zFile);
+
+    if (zFile.id != ZIPFile::ID) {
+      throw std::runtime_error("Invalid ZIP central directory entry: " +
+                               zipFile);
+    }
+
+    if (zFile.compression != ZIPCompressionMethod::Store) {
+      throw std::runtime_error("Only stored ZIP entries can be merged: " +
+                               zipFile);
+    }
+
+    std::string fileName;
+    fileName.resize(zFile.fileNameSize);
+    rd.ReadBuffer(fileName.data(), fileName.size());
+
+    uint64 fileSize = zFile.uncompressedSize;
+    uint64 localHeaderOffset = zFile.localHeaderOffset;
+    const size_t extraEnd = rd.Tell() + zFile.extraFieldSize;
+
+    // Only ZIP64 extra is kept, spike cache extra is regenerated
+    while (rd.Tell() + 4 <= extraEnd) {
+      uint16 extraId;
+      uint16 extraSize;
+      rd.Read(extraId);
+      rd.Read(extraSize);
+      const size_t nextExtra = rd.Tell() + extraSize;
+
+      if (extraId == 1) {
+        if (zFile.uncompressedSize == 0xffffffff) {
+          rd.Read(fileSize);
+        }
+
+        if (zFile.compressedSize == 0xffffffff) {
+          rd.Skip(8);
+        }
+
+        if (zFile.localHeaderOffset == 0xffffffff) {
+          rd.Read(localHeaderOffset);
+        }
+      }
+
+      rd.Seek(nextExtra);
+    }
+
+    rd.Seek(extraEnd + zFile.fileCommentSize);
+    rd.Push();
+    rd.Seek(localHeaderOffset);
+    ZIPLocalFile zLocalFile;
+    rd.Read(zLocalFile);
+    const size_t fileDataBegin =
+        rd.Tell() + zLocalFile.fileNameSize + zLocalFile.extraFieldSize;
+    rd.Pop();
+
+    AppendEntry(zFile, fileName, localHeaderOffset + filesSize, fileSize,
+                fileDataBegin + filesSize);
+  }
+
+  // Local records are copied as they are, only central entries are relocated
+  rd.Seek(0);
+  const size_t numBlocks = dirOffset / sizeof(buffer);
+  const size_t restBytes = dirOffset % sizeof(buffer);
+
+  for (size_t b = 0; b < numBlocks; b++) {
+    rd.ReadBuffer(buffer, sizeof(buffer));
+    records.WriteBuffer(buffer, sizeof(buffer));
+  }
+
+  if (restBytes) {
+    rd.ReadBuffer(buffer, restBytes);
+    records.WriteBuffer(buffer, restBytes);
+  }
 }
 
 void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
@@ -415,8 +810,8 @@ void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
   zCentral.id = ZIPCentralDir::ID;
   SafeCast(zCentral.numDirEntries, numEntries);
   SafeCast(zCentral.numDiskEntries, numEntries);
-  SafeCast(zCentral.dirSize, entriesSize);
   SafeCast(zCentral.dirOffset, dirOffset);
+  size_t dirSize = entriesSize;
 
   for (size_t b = 0; b < numBlocks; b++) {
     rd.ReadBuffer(buffer, sizeof(buffer));
@@ -436,7 +831,7 @@ void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
     rd.Skip(-skipValue);
     rd.ReadBuffer(buffer, skipValue);
     std::string_view sv(buffer, skipValue);
-    size_t foundLastEntry = sv.find_last_of("PK\x01\x02");
+    size_t foundLastEntry = sv.rfind("PK\x01\x02");
     validCacheEntry = foundLastEntry != sv.npos;
 
     if (validCacheEntry) {
@@ -444,7 +839,7 @@ void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
       uint16 extraFieldSize =
           *reinterpret_cast<uint16 *>(buffer + foundLastEntry);
       records.Push();
-      records.Skip(-(skipValue - foundLastEntry + 3));
+      records.Skip(-(skipValue - foundLastEntry));
       records.Write<uint16>(extraFieldSize + 4 + sizeof(CacheBaseHeader));
       records.Pop();
 
@@ -452,17 +847,21 @@ void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
       records.Write<uint16>(sizeof(CacheBaseHeader));
       cache.meta.zipCheckupOffset = records.Tell();
       records.Write(cache.meta);
+      dirSize += sizeof(CacheBaseHeader) + 4;
     }
   }
 
+  SafeCast(zCentral.dirSize, dirSize);
+
   if (forcex64) {
     ZIP64CentralDir zCentral64{};
     zCentral64.id = ZIP64CentralDir::ID;
     zCentral64.madeBy = 10;
     zCentral64.extractVersion = 10;
+    zCentral64.dirRecord = 44;
     zCentral64.numDiskEntries = numEntries;
     zCentral64.numDirEntries = numEntries;
-    zCentral64.dirSize = entriesSize;
+    zCentral64.dirSize = dirSize;
     zCentral64.dirOffset = dirOffset;
 
     const size_t centralOffset = records.Tell();
@@ -471,6 +870,7 @@ void ZIPMerger::FinishMerge(cache_begin_cb cacheBeginCB) {
     ZIP64CentralDirLocator zLoca{};
     zLoca.id = ZIP64CentralDirLocator::ID;
     zLoca.centralDirOffset = centralOffset;
+    zLoca.numDisks = 1;
     records.Write(zLoca);
   }
 
@@ -21,13 +21,52 @@
 #include "datas/app_context.hpp"
 #include "datas/binwritter.hpp"
 #include "formats/ZIP.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 struct CounterLine;
 
+// Large owned blocks are written in background by a single worker,
+// at most MAX_QUEUED blocks can wait for it
+struct AsyncDataSink {
+  static constexpr size_t ASYNC_THRESHOLD = 0x10000;
+  static constexpr size_t MAX_QUEUED = 4;
+  using write_type = std::function<void(es::string_view)>;
+
+  AsyncDataSink() = default;
+  AsyncDataSink(const AsyncDataSink &) = delete;
+  ~AsyncDataSink();
+
+  // Waits for queued writes, rethrows error of background write
+  void Wait();
+  void Send(const es::string_view *buffers, size_t numBuffers,
+            std::unique_ptr<AppDataOwner> owner, write_type write);
+
+private:
+  struct Job {
+    std::unique_ptr<AppDataOwner> owner;
+    std::vector<es::string_view> blocks;
+    write_type write;
+  };
+
+  std::thread worker;
+  std::mutex mtx;
+  std::condition_variable signal;
+  std::deque<Job> queue;
+  std::exception_ptr error;
+  bool busy = false;
+  bool stop = false;
+
+  void Worker();
+};
+
 struct ZIPExtactContext : AppExtractContext {
   ZIPExtactContext(const std::string &outFile)
       : records(outFile), outputFile(outFile), entries(entriesStream),
@@ -40,6 +79,8 @@ struct ZIPExtactContext : AppExtractContext {
 
   void NewFile(const std::string &path) override;
   void SendData(es::string_view data) override;
+  void SendBuffers(const es::string_view *buffers, size_t numBuffers,
+                   std::unique_ptr<AppDataOwner> owner) override;
   bool RequiresFolders() const override;
   void AddFolderPath(const std::string &path) override;
   void GenerateFolders() override;
@@ -63,26 +104,39 @@ private:
   std::string curFileName;
   std::optional<CacheGenerator> cache;
   std::vector<uint64> fileOffsets;
+  AsyncDataSink sink;
   void FinishFile(bool final = false);
+  void WriteData(es::string_view data);
 };
 
 struct ZIPMerger {
-  ZIPMerger(const std::string &outFiles, const std::string &outEntries)
-      : entries(outEntries), records(outFiles), entriesFile(outEntries),
-        outFile(outFiles) {
-  }
+  // Non zero resumeSize continues unfinished outFiles, which is truncated to
+  // resumeSize
+  ZIPMerger(const std::string &outFiles, const std::string &outEntries,
+            size_t resumeSize = 0);
   ZIPMerger() = default;
   using cache_begin_cb = void (*)();
-  void Merge(ZIPExtactContext &other, const std::string &recordsFile);
+  // Non empty journalKey is journaled as merged together with output size
+  void Merge(ZIPExtactContext &other, const std::string &recordsFile,
+             es::string_view journalKey = {});
+  // Append every entry of stored (uncompressed) ZIP, used for shard fragments
+  void MergeArchive(const std::string &zipFile);
   void FinishMerge(cache_begin_cb cacheBeginCB);
 
 private:
   BinWritter entries;
-  BinWritter records;
+  // Opened at end of existing file, see constructor
+  BinWritter_t<BinCoreOpenMode::Ate> records;
   std::string entriesFile;
   std::string outFile;
   size_t numEntries = 0;
   CacheGenerator cache;
+
+  void AppendEntry(ZIPFile zFile, const std::string &fileName,
+                   uint64 localHeaderOffset, uint64 fileSize,
+                   uint64 fileDataBegin);
+  // Make central entries for local records of outFile up to validSize
+  void ResumeArchive(size_t validSize);
 };
 
 struct IOExtractContext : AppExtractContext, BinWritter {
@@ -95,7 +149,12 @@ struct IOExtractContext : AppExtractContext, BinWritter {
 
   void NewFile(const std::string &path) override;
   void SendData(es::string_view data) override;
+  void SendBuffers(const es::string_view *buffers, size_t numBuffers,
+                   std::unique_ptr<AppDataOwner> owner) override;
   bool RequiresFolders() const override;
   void AddFolderPath(const std::string &path) override;
   void GenerateFolders() override;
+
+private:
+  AsyncDataSink sink;
 };
@@ -0,0 +1,143 @@
+/*  Spike is universal dedicated module handler
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "report.hpp"
+#include "datas/binwritter.hpp"
+#include "datas/master_printer.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_MSC_VER) || defined(__MINGW64__)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static size_t PeakRSS() {
+#if defined(_MSC_VER) || defined(__MINGW64__)
+  PROCESS_MEMORY_COUNTERS counters{};
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize;
+#else
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void StartReport() { StartSpanStats(); }
+
+static double ToSeconds(trace_clock::duration dur) {
+  return std::chrono::duration<double>(dur).count();
+}
+
+static double ToMB(size_t numBytes) { return numBytes / double(1 << 20); }
+
+void WriteReport(const std::string &path) {
+  const double wallTime = ToSeconds(trace_clock::now() - SpansOrigin());
+  const size_t peakRSS = PeakRSS();
+  auto lanes = CollectSpanStats();
+  std::vector<SpanStats> stages;
+  size_t bytesRead = 0;
+  size_t bytesWritten = 0;
+
+  for (auto &l : lanes) {
+    for (auto &s : l.spans) {
+      auto found = std::find_if(stages.begin(), stages.end(), [&](auto &item) {
+        return !strcmp(item.name, s.name);
+      });
+
+      if (found == stages.end()) {
+        stages.push_back(s);
+      } else {
+        found->count += s.count;
+        found->bytesIn += s.bytesIn;
+        found->bytesOut += s.bytesOut;
+        found->total += s.total;
+      }
+
+      bytesRead += s.bytesIn;
+      bytesWritten += s.bytesOut;
+    }
+  }
+
+  auto Throughput = [](const SpanStats &s) {
+    const double busy = ToSeconds(s.total);
+    return busy > 0 ? ToMB(s.bytesIn + s.bytesOut) / busy : 0.0;
+  };
+
+  std::stringstream text;
+  text << std::fixed << std::setprecision(3) << "Run report:\n  wall time "
+       << wallTime << " s, read " << ToMB(bytesRead) << " MB, written "
+       << ToMB(bytesWritten) << " MB, peak RSS " << ToMB(peakRSS) << " MB\n";
+
+  for (auto &s : stages) {
+    text << "  " << s.name << ": " << s.count << "x, " << ToSeconds(s.total)
+         << " s, " << (wallTime > 0 ? s.count / wallTime : 0.0) << " /s";
+
+    if (s.bytesIn || s.bytesOut) {
+      text << ", " << Throughput(s) << " MB/s";
+    }
+
+    text << '\n';
+  }
+
+  for (auto &l : lanes) {
+    const double busy = ToSeconds(l.busy);
+    text << "  lane " << l.laneIndex << ": busy " << busy << " s, idle "
+         << std::max(wallTime - busy, 0.0) << " s\n";
+  }
+
+  printinfo(text.str());
+
+  BinWritter_t<BinCoreOpenMode::Text> wr(path);
+  auto &str = wr.BaseStream();
+  str << std::fixed << std::setprecision(6) << "{\"wallTime\":" << wallTime
+      << ",\"bytesRead\":" << bytesRead << ",\"bytesWritten\":" << bytesWritten
+      << ",\"peakRSS\":" << peakRSS << ",\n\"stages\":[";
+
+  for (bool first = true; auto &s : stages) {
+    str << (first ? "\n" : ",\n") << "{\"name\":\"" << s.name
+        << "\",\"count\":" << s.count << ",\"time\":" << ToSeconds(s.total)
+        << ",\"bytesIn\":" << s.bytesIn << ",\"bytesOut\":" << s.bytesOut
+        << ",\"itemsPerSecond\":" << (wallTime > 0 ? s.count / wallTime : 0.0)
+        << ",\"MBPerSecond\":" << Throughput(s) << '}';
+    first = false;
+  }
+
+  str << "\n],\n\"lanes\":[";
+
+  for (bool first = true; auto &l : lanes) {
+    const double busy = ToSeconds(l.busy);
+    str << (first ? "\n" : ",\n") << "{\"lane\":" << l.laneIndex
+        << ",\"busy\":" << busy
+        << ",\"idle\":" << std::max(wallTime - busy, 0.0) << '}';
+    first = false;
+  }
+
+  str << "\n]}\n";
+}
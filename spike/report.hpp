@@ -0,0 +1,25 @@
+/*  Spike is universal dedicated module handler
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include <string>
+
+// Collects span statistics, bytes and lock waits for end of run report
+void StartReport();
+// Prints human readable summary and writes JSON into path
+void WriteReport(const std::string &path);
@@ -22,14 +22,38 @@
 #include "datas/binreader.hpp"
 #include "datas/directory_scanner.hpp"
 #include "datas/fileinfo.hpp"
+#include "datas/jenkinshash.hpp"
 #include "datas/master_printer.hpp"
 #include "datas/multi_thread.hpp"
 #include "datas/pugiex.hpp"
 #include "datas/stat.hpp"
 #include "datas/tchar.hpp"
+#include "journal.hpp"
 #include "out_context.hpp"
 #include "project.h"
+#include "report.hpp"
 #include "tmp_storage.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <tuple>
+
+#if !(defined(_MSC_VER) || defined(__MINGW64__))
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
 
 #ifndef SPIKE_USE_THREADS
 #define SPIKE_USE_THREADS NDEBUG
@@ -42,6 +66,246 @@ static const char appHeader1[] =
     " [options] path1 path2 ...\nTool can detect and scan folders and "
     "uncompressed zip archives.";
 
+// Options handled by spike itself, they don't affect config loading
+struct SpikeOptions {
+  std::string traceFile;
+  std::string reportFile;
+  std::string shard;
+  std::string journalFile;
+  bool fusedStat = false;
+  bool physicalOrder = false;
+  bool nestedArchives = false;
+  bool convertZIP = false;
+  std::vector<std::string> overlays;
+};
+
+static SpikeOptions spikeOptions;
+
+// Parsed --shard, every process with same inputs selects disjoint subset
+static struct {
+  size_t index = 0;
+  size_t count = 1;
+} shardSettings;
+
+// Assignment is based on path hash, so it doesn't need any shared state
+// Path must be relative to input root, so every process sees same key
+static bool IsInShard(es::string_view path) {
+  if (shardSettings.count < 2) {
+    return true;
+  }
+
+  return JenkinsHash_(path) % shardSettings.count == shardSettings.index;
+}
+
+// Shard runs produce fragments for spike --merge
+static std::string OutputZIPName(const std::string &base) {
+  if (shardSettings.count > 1) {
+    return base + "_out.shard" + std::to_string(shardSettings.index) + ".zip";
+  }
+
+  return base + "_out.zip";
+}
+
+// Extension check of nested archives, case insensitive
+// Containers of module formats are not recursed into, only stored ZIPs
+static bool IsZIPName(es::string_view name) {
+  if (name.size() < 4) {
+    return false;
+  }
+
+  name.remove_prefix(name.size() - 4);
+
+  return std::equal(name.begin(), name.end(), ".zip", [](char a, char b) {
+    return std::tolower(static_cast<unsigned char>(a)) == b;
+  });
+}
+
+// Journaled part of interrupted output is continued in place
+static void StartOutputZIP(ZIPMerger &merger, const std::string &outZip,
+                           size_t resumeSize) {
+  if (resumeSize) {
+    printinfo("Resuming " << outZip << " at " << resumeSize << " bytes");
+  }
+
+  new (&merger) ZIPMerger(outZip, RequestTempFile(), resumeSize);
+}
+
+// Either value, flag or list member is set
+// Session options are applied once per process and can't be set by server
+// jobs
+struct SpikeOptionDesc {
+  es::string_view name;
+  es::string_view valueName;
+  es::string_view description;
+  std::string SpikeOptions::*value = nullptr;
+  bool SpikeOptions::*flag = nullptr;
+  std::vector<std::string> SpikeOptions::*list = nullptr;
+  bool session = false;
+};
+
+static const SpikeOptionDesc SPIKE_OPTIONS[]{
+    {"trace", "<file>",
+     "Write Chrome trace event JSON of processing stages into file.",
+     &SpikeOptions::traceFile, nullptr, nullptr, true},
+    {"report", "<file>",
+     "Print throughput and utilization summary and write it as JSON into "
+     "file.",
+     &SpikeOptions::reportFile, nullptr, nullptr, true},
+    {"shard", "<i/n>",
+     "Process only i-th of n deterministic subsets of input files or ZIP "
+     "entries. ZIP outputs are written as fragments for spike --merge.",
+     &SpikeOptions::shard, nullptr, nullptr, true},
+    {"resume", "<file>",
+     "Record finished inputs into journal file. When journal exists, "
+     "finished inputs are skipped and unfinished output ZIPs are continued.",
+     &SpikeOptions::journalFile, nullptr, nullptr, true},
+    {"fused-stat", "",
+     "Don't run extract stats pass before extraction, stats of every file "
+     "or ZIP entry are gathered right before it's extracted, reusing opened "
+     "file.",
+     nullptr, &SpikeOptions::fusedStat},
+    {"physical-order", "",
+     "Process files in order of their location on disk and ZIP entries in "
+     "order of their offset within archive. Useful for spinning disks.",
+     nullptr, &SpikeOptions::physicalOrder},
+    {"nested", "",
+     "Process entries of stored ZIP archives within ZIP inputs directly "
+     "from outer archive, without extracting them first. Only entries with "
+     ".zip extension are recursed into, archives in other formats, "
+     "including those extracted by modules, are processed as regular files.",
+     nullptr, &SpikeOptions::nestedArchives},
+    {"convert-zip", "",
+     "CONVERT mode, files created through module's output context are "
+     "written into single ZIP with cache instead of loose files.",
+     nullptr, &SpikeOptions::convertZIP},
+    {"overlay", "<path>",
+     "Mount ZIP or folder as overlay layer, can be used multiple times, later "
+     "layers win. Files requested by module are looked up in overlay first.",
+     nullptr, nullptr, &SpikeOptions::overlays, true},
+};
+
+// Returns number of consumed arguments, 0 when not a spike option
+static int ApplySpikeOption(int argc, TCHAR *argv[], int index,
+                            bool serverJob = false) {
+  auto optStr = std::to_string(argv[index]);
+
+  if (!es::string_view(optStr).begins_with("--")) {
+    return 0;
+  }
+
+  es::string_view optName(optStr);
+  optName.remove_prefix(2);
+
+  for (auto &o : SPIKE_OPTIONS) {
+    if (o.name != optName) {
+      continue;
+    }
+
+    if (serverJob && o.session) {
+      throw std::runtime_error("Option --" + std::string(o.name) +
+                               " can be only set when starting server.");
+    }
+
+    if (o.flag) {
+      spikeOptions.*o.flag = true;
+      return 1;
+    }
+
+    if (index + 1 >= argc) {
+      printerror("Option --" << o.name << " expects " << o.valueName);
+      return 1;
+    }
+
+    if (o.list) {
+      (spikeOptions.*o.list).emplace_back(std::to_string(argv[index + 1]));
+    } else {
+      spikeOptions.*o.value = std::to_string(argv[index + 1]);
+    }
+
+    return 2;
+  }
+
+  return 0;
+}
+
+static void PrintSpikeOptionsHelp() {
+  printline("Spike options:" << std::endl);
+
+  for (auto &o : SPIKE_OPTIONS) {
+    if (o.flag) {
+      printline("--" << o.name << "  = " << o.description);
+    } else {
+      printline("--" << o.name << ' ' << o.valueName << "  = "
+                     << o.description);
+    }
+  }
+
+  printline("");
+}
+
+// Source of physical sort key, files are grouped by it
+// Offsets and inode numbers are not comparable with each other
+enum class PhysicalKey : uint8 {
+  Extent,  // First physical extent (FIEMAP)
+  Inode,   // Usually follows allocation order
+  Unknown, // Keeps original order
+};
+
+static std::pair<PhysicalKey, uint64> PhysicalOffset(const std::string &path) {
+#if defined(_MSC_VER) || defined(__MINGW64__)
+  return {PhysicalKey::Unknown, 0};
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    return {PhysicalKey::Unknown, 0};
+  }
+
+  std::pair<PhysicalKey, uint64> retVal{PhysicalKey::Unknown, 0};
+
+#ifdef __linux__
+  alignas(fiemap) char request[sizeof(fiemap) + sizeof(fiemap_extent)]{};
+  auto map = reinterpret_cast<fiemap *>(request);
+  map->fm_length = FIEMAP_MAX_OFFSET;
+  map->fm_extent_count = 1;
+
+  if (!ioctl(fd, FS_IOC_FIEMAP, map) && map->fm_mapped_extents) {
+    retVal = {PhysicalKey::Extent, map->fm_extents[0].fe_physical};
+  }
+#endif
+
+  if (struct stat fileStat;
+      retVal.first == PhysicalKey::Unknown && !fstat(fd, &fileStat)) {
+    retVal = {PhysicalKey::Inode, fileStat.st_ino};
+  }
+
+  close(fd);
+
+  return retVal;
+#endif
+}
+
+// Mapped files come first by offset, then the rest by inode
+static void SortByPhysicalOffset(std::vector<std::string> &files) {
+  TraceSpan span("Physical order");
+  std::vector<std::tuple<PhysicalKey, uint64, size_t>> keys(files.size());
+
+  for (size_t i = 0; i < files.size(); i++) {
+    auto [source, offset] = PhysicalOffset(files[i]);
+    keys[i] = {source, offset, i};
+  }
+
+  std::sort(keys.begin(), keys.end());
+  std::vector<std::string> sorted;
+  sorted.reserve(files.size());
+
+  for (auto &[source, offset, index] : keys) {
+    sorted.emplace_back(std::move(files[index]));
+  }
+
+  files = std::move(sorted);
+}
+
 struct ScanningFoldersBar : LoadingBar {
   char buffer[512]{};
   size_t modifyPos = 0;
@@ -67,14 +331,15 @@ struct ProcessedFiles : LoadingBar, CounterLine {
   char buffer[128]{};
 
   ProcessedFiles() : LoadingBar({buffer, sizeof(buffer)}) {}
-  void PrintLine() override {
+  void PrintLine(std::string &out) override {
     snprintf(buffer, sizeof(buffer), "Extracted %4" PRIuMAX " files.",
              curitem.load(std::memory_order_relaxed));
-    LoadingBar::PrintLine();
+    LoadingBar::PrintLine(out);
   }
 };
 
 struct UILines {
+  // Estimated number of items per ZIP, until its stats are known
   size_t numFiles;
   ProgressBar *totalProgress;
   CounterLine *totalCount;
@@ -103,44 +368,188 @@ struct UILines {
   };
 };
 
+// Probed chunks are kept until stat is done, so returned views stay valid
+static size_t ExtractStat(APPContext &ctx, BinReaderRef rd) {
+  if (ctx.ExtractStatSpan) {
+    std::map<std::pair<size_t, size_t>, std::string> chunks;
+
+    return ctx.ExtractStatSpan(
+        [&](size_t offset, size_t size) -> es::string_view {
+          auto [chunk, isNew] = chunks.try_emplace({offset, size});
+
+          if (isNew) {
+            rd.Seek(offset);
+            rd.ReadContainer(chunk->second, size);
+          }
+
+          return chunk->second;
+        });
+  }
+
+  return ctx.ExtractStat([&](size_t offset, size_t size) {
+    rd.Seek(offset);
+    std::string data;
+    rd.ReadContainer(data, size);
+    return data;
+  });
+}
+
+static es::string_view StatChunk(es::string_view data, size_t offset,
+                                  size_t size) {
+  if (offset > data.size() || size > data.size() - offset) {
+    throw std::out_of_range("Requested chunk is out of file bounds.");
+  }
+
+  return data.substr(offset, size);
+}
+
+static size_t ExtractStat(APPContext &ctx, es::string_view data) {
+  if (ctx.ExtractStatSpan) {
+    return ctx.ExtractStatSpan([&](size_t offset, size_t size) {
+      return StatChunk(data, offset, size);
+    });
+  }
+
+  return ctx.ExtractStat([&](size_t offset, size_t size) {
+    return StatChunk(data, offset, size).to_string();
+  });
+}
+
+// Span requests are served from mapped archive
+static size_t ExtractStat(APPContext &ctx, ZIPIOContext &fctx,
+                          const ZipEntry &entry) {
+  if (ctx.ExtractStatSpan) {
+    return ctx.ExtractStatSpan([&](size_t offset, size_t size) {
+      return StatChunk(fctx.GetView(entry), offset, size);
+    });
+  }
+
+  return ctx.ExtractStat([&](size_t offset, size_t size) {
+    return fctx.GetChunk(entry, offset, size);
+  });
+}
+
 void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
                                    PathFilter &pathFilter, APPContext &ctx,
                                    UILines &lines) {
-  size_t processedSoFar = lines.numFiles;
-  size_t remainingZips = zips.size();
-
   for (auto &[path, filter] : zips) {
-    remainingZips--;
+    std::string outPath = AFileInfo(path).GetFullPathNoExt().to_string();
+    const bool zipOutput = ctx.info->mode == AppMode_e::EXTRACT
+                               ? mainSettings.extractSettings.makeZIP
+                               : spikeOptions.convertZIP;
+    const std::string outZip = OutputZIPName(outPath);
+
+    if (zipOutput && IsJournaledFinished(outZip)) {
+      printinfo("Skipping finished ZIP: " << path);
+
+      if (lines.totalProgress) {
+        lines.totalProgress->AddItemCount(-int64(lines.numFiles));
+      }
+
+      continue;
+    }
+
+    // Resolved before entries are listed, missing output drops journaled keys
+    const size_t resumeSize = zipOutput ? JournaledZIPSize(outZip) : 0;
     auto labelData = "Loading ZIP vfs: " + path;
     auto loadBar = AppendNewLogLine<LoadingBar>(labelData);
+    // Module filters would drop nested archives, whole index is needed
     const bool loadFiltered =
-        ctx.info->arcLoadType == ArchiveLoadType::FILTERED;
-    auto fctx = loadFiltered ? MakeZIPContext(path, filter, pathFilter)
-                             : MakeZIPContext(path);
-    AFileInfo zFile(path);
+        ctx.info->arcLoadType == ArchiveLoadType::FILTERED &&
+        !spikeOptions.nestedArchives;
+    auto fctx = [&, &path = path, &filter = filter] {
+      TraceSpan span("Load ZIP index", path);
+      return loadFiltered ? MakeZIPContext(path, filter, pathFilter)
+                          : MakeZIPContext(path);
+    }();
     std::vector<ZIPIOEntry> filesToProcess;
+    // Context and name prefix of main and nested archives
+    // Nested entries use own context for RequestFile/FindFile, but their data
+    // is accessible through fctx
+    std::vector<std::pair<ZIPIOContext *, std::string>> archives{
+        {fctx.get(), {}}};
+    // Index into archives of every filesToProcess entry
+    std::vector<size_t> entryArchives;
+    std::vector<std::unique_ptr<ZIPIOContext>> nestedContexts;
+    // Sharded or reordered entries are always collected
+    const bool listEntries = !loadFiltered || shardSettings.count > 1 ||
+                             spikeOptions.physicalOrder || JournalActive();
+
+    if (listEntries) {
+      // Nested archives are appended while iterating
+      for (size_t a = 0; a < archives.size(); a++) {
+        auto [arc, prefix] = archives[a];
+        auto vfsIter = arc->Iter();
+
+        for (auto f : vfsIter) {
+          if (!prefix.empty()) {
+            f.name = prefix + f.AsView().to_string();
+          }
 
-    if (!loadFiltered) {
-      auto vfsIter = fctx->Iter();
+          if (spikeOptions.nestedArchives && IsZIPName(f.AsView())) {
+            try {
+              TraceSpan span("Load nested ZIP index", f.AsView());
+              nestedContexts.emplace_back(MakeZIPContext(path, f));
+              archives.emplace_back(nestedContexts.back().get(),
+                                    f.AsView().to_string() + '/');
+              continue;
+            } catch (const std::exception &e) {
+              printwarning("Skipping nested archive " << f.AsView() << ": "
+                                                      << e.what());
+            }
+          }
 
-      for (auto f : vfsIter) {
-        auto item = f.AsView();
-        if (size_t lastSlash = item.find_last_of("/\\");
-            lastSlash != item.npos) {
-          item.remove_prefix(lastSlash + 1);
+          if (!IsInShard(f.AsView()) ||
+              IsJournaledDone(path + '/' + f.AsView().to_string())) {
+            continue;
+          }
+
+          if (loadFiltered) {
+            filesToProcess.push_back(f);
+            entryArchives.push_back(a);
+            continue;
+          }
+
+          auto item = f.AsView();
+          if (size_t lastSlash = item.find_last_of("/\\");
+              lastSlash != item.npos) {
+            item.remove_prefix(lastSlash + 1);
+          }
+
+          if (pathFilter.IsFiltered(item) && filter.IsFiltered(item)) {
+            filesToProcess.push_back(f);
+            entryArchives.push_back(a);
+          }
         }
+      }
 
-        if (pathFilter.IsFiltered(item) && filter.IsFiltered(item)) {
-          filesToProcess.push_back(f);
+      // Workers claim entries in order, so reads follow archive layout
+      // Entries are ordered per archive, nested archives follow main one
+      if (spikeOptions.physicalOrder) {
+        std::vector<size_t> order(filesToProcess.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+          return std::make_pair(entryArchives[a], filesToProcess[a].offset) <
+                 std::make_pair(entryArchives[b], filesToProcess[b].offset);
+        });
+        std::vector<ZIPIOEntry> sortedFiles;
+        std::vector<size_t> sortedArchives;
+
+        for (size_t i : order) {
+          sortedFiles.emplace_back(std::move(filesToProcess[i]));
+          sortedArchives.push_back(entryArchives[i]);
         }
+
+        filesToProcess = std::move(sortedFiles);
+        entryArchives = std::move(sortedArchives);
       }
     }
 
-    std::string outPath = zFile.GetFullPathNoExt();
     ZIPMerger mainZip;
 
-    if (ctx.info->mode == AppMode_e::CONVERT ||
-        !mainSettings.extractSettings.makeZIP) {
+    // CONVERT mode outFile is located within output folder, even when
+    // output context writes into ZIP
+    if (!zipOutput || ctx.info->mode == AppMode_e::CONVERT) {
       es::mkdir(outPath);
       outPath.push_back('/');
       IOExtractContext ctx_(outPath);
@@ -160,7 +569,7 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
         }
       };
 
-      if (!loadFiltered) {
+      if (listEntries) {
         AddFolder(filesToProcess);
       } else {
         auto vfsIter = fctx->Iter();
@@ -168,9 +577,10 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
       }
 
       ctx_.GenerateFolders();
-    } else {
-      auto outZip = outPath + "_out.zip";
-      new (&mainZip) ZIPMerger(outZip, RequestTempFile());
+    }
+
+    if (zipOutput) {
+      StartOutputZIP(mainZip, outZip, resumeSize);
     }
 
     loadBar->Finish();
@@ -179,36 +589,48 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
     auto vfsIter = fctx->Iter();
     auto vfsIterBegin = vfsIter.begin();
     const size_t numFiles =
-        loadFiltered ? vfsIter.base->Count() : filesToProcess.size();
+        listEntries ? filesToProcess.size() : vfsIter.base->Count();
     std::vector<size_t> archiveFiles;
     std::atomic_size_t numFilesToProcess{0};
 
-    if (ctx.info->mode == AppMode_e::EXTRACT && ctx.ExtractStat) {
-      auto scanBar = AppendNewLogLine<LoadingBar>("Processing extract stats.");
+    // Stats are gathered by workers, total grows as entries are processed
+    const bool fusedStat = spikeOptions.fusedStat &&
+                           ctx.info->mode == AppMode_e::EXTRACT &&
+                           ctx.HasExtractStat();
+
+    if (ctx.info->mode == AppMode_e::EXTRACT && ctx.HasExtractStat()) {
       archiveFiles.resize(numFiles);
-      auto vfsInternalIter = fctx->Iter();
-      auto vfsInternalIterBegin = vfsInternalIter.begin();
-      RunThreadedQueue(numFiles, [&](size_t index) {
-        auto &&fileEntry = [&] {
-          if (!loadFiltered) {
-            return filesToProcess[index];
-          } else {
-            return vfsInternalIterBegin++;
-          }
-        }();
+      LoadingBar *scanBar = nullptr;
 
-        auto numFiles = ctx.ExtractStat(std::bind(
-            [&](size_t offset, size_t size) {
-              return fctx->GetChunk(fileEntry, offset, size);
-            },
-            std::placeholders::_1, std::placeholders::_2));
+      if (fusedStat) {
+        // Estimate of one item per entry
+        numFilesToProcess = numFiles;
+      } else {
+        scanBar = AppendNewLogLine<LoadingBar>("Processing extract stats.");
+        auto vfsInternalIter = fctx->Iter();
+        auto vfsInternalIterBegin = vfsInternalIter.begin();
+        TraceSpan statSpan("Extract stat pass");
+        RunThreadedQueue(numFiles, [&](size_t index) {
+          auto &&fileEntry = [&] {
+            if (listEntries) {
+              return filesToProcess[index];
+            } else {
+              return vfsInternalIterBegin++;
+            }
+          }();
 
-        archiveFiles[index] = numFiles;
-        numFilesToProcess.fetch_add(numFiles, std::memory_order_relaxed);
-      });
+          TraceSpan span("AppExtractStat", fileEntry.AsView());
+          auto numFiles = ExtractStat(ctx, *fctx, fileEntry);
+
+          archiveFiles[index] = numFiles;
+          numFilesToProcess.fetch_add(numFiles, std::memory_order_relaxed);
+        });
+      }
 
       ModifyElements([&](ElementAPI &api) {
-        api.Remove(scanBar);
+        if (scanBar) {
+          api.Remove(scanBar);
+        }
 
         const size_t minThreads =
             std::min(size_t(std::thread::hardware_concurrency()),
@@ -230,11 +652,9 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
     }
 
     if (lines.totalProgress) {
-      lines.totalProgress->ItemCount(processedSoFar + numFilesToProcess +
-                                         (remainingZips * lines.numFiles),
-                                     processedSoFar);
+      lines.totalProgress->AddItemCount(int64(numFilesToProcess) -
+                                        int64(lines.numFiles));
     }
-    processedSoFar += numFilesToProcess;
 
 #if SPIKE_USE_THREADS
     RunThreadedQueue(numFiles, [&, &path = path](size_t index) {
@@ -243,15 +663,31 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
     for (size_t index = 0; index < numFiles; index++) {
 #endif
         auto &&fileEntry = [&] {
-          if (!loadFiltered) {
+          if (listEntries) {
             return filesToProcess[index];
           } else {
             return vfsIterBegin++;
           }
         }();
         AFileInfo cFile(fileEntry.AsView());
-        auto appCtx = std::make_unique<ZIPIOContextInstance>(fctx.get());
-        appCtx->workingFile = fileEntry.AsView();
+        auto &[entryContext, entryPrefix] =
+            archives.at(listEntries ? entryArchives[index] : 0);
+        auto appCtx = std::make_unique<ZIPIOContextInstance>(entryContext);
+        // Prefixed name is used only for output and journal, working file
+        // must match vfs of entry's own context
+        appCtx->workingFile = fileEntry.AsView().substr(entryPrefix.size());
+        const std::string journalKey =
+            path + '/' + fileEntry.AsView().to_string();
+
+        if (fusedStat) {
+          TraceSpan span("AppExtractStat", fileEntry.AsView());
+          archiveFiles[index] = ExtractStat(ctx, *fctx, fileEntry);
+
+          if (lines.totalProgress) {
+            lines.totalProgress->AddItemCount(int64(archiveFiles[index]) - 1);
+          }
+        }
+
         auto currentBar = lines.ChooseBar();
 
         if (currentBar) {
@@ -293,24 +729,84 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
           }
 
           ectx->ctx = appCtx.get();
-          auto fileStream = fctx->OpenFile(fileEntry);
-          ctx.ExtractFile(*fileStream, ectx.get());
-          fctx->DisposeFile(fileStream);
+
+          if (ctx.ExtractBuffer) {
+            TraceSpan span("AppExtractBuffer", fileEntry.AsView());
+            TraceBytesIn(fileEntry.size);
+            ctx.ExtractBuffer(fctx->GetView(fileEntry), ectx.get());
+          } else {
+            auto fileStream = [&] {
+              TraceSpan span("Open", fileEntry.AsView());
+              return fctx->OpenFile(fileEntry);
+            }();
+
+            {
+              TraceSpan span("AppExtractFile", fileEntry.AsView());
+              TraceBytesIn(fileEntry.size);
+              ctx.ExtractFile(*fileStream, ectx.get());
+            }
+
+            fctx->DisposeFile(fileStream);
+          }
 
           if (mainSettings.extractSettings.makeZIP) {
             auto zCtx = static_cast<ZIPExtactContext *>(ectx.get());
-            mainZip.Merge(*zCtx, recordsFile);
+            TraceSpan span("Merge", fileEntry.AsView());
+            mainZip.Merge(*zCtx, recordsFile, journalKey);
             es::Dispose(ectx);
             es::RemoveFile(recordsFile);
+          } else if (JournalActive()) {
+            JournalDone(journalKey);
           }
         } else {
           printline("Processing: " << path << '/' << fileEntry.AsView());
-          auto fileStream = fctx->OpenFile(fileEntry);
+          appCtx->outFile = outPath + fileEntry.AsView().to_string();
+          std::string recordsFile;
+          ZIPExtactContext *zipOutputCtx = nullptr;
+          appCtx->makeOutput = [&]() -> std::unique_ptr<AppExtractContext> {
+            if (!zipOutput) {
+              return std::make_unique<IOExtractContext>(
+                  outPath + cFile.GetFolder().to_string());
+            }
+
+            recordsFile = RequestTempFile();
+            auto zCtx = std::make_unique<ZIPExtactContext>(recordsFile, false);
+            zCtx->prefixPath = cFile.GetFolder().to_string();
+            zipOutputCtx = zCtx.get();
+            return zCtx;
+          };
+
+          if (ctx.ProcessBuffer) {
+            TraceSpan span("AppProcessBuffer", fileEntry.AsView());
+            TraceBytesIn(fileEntry.size);
+            ctx.ProcessBuffer(fctx->GetView(fileEntry), appCtx.get());
+          } else {
+            auto fileStream = [&] {
+              TraceSpan span("Open", fileEntry.AsView());
+              return fctx->OpenFile(fileEntry);
+            }();
+
+            {
+              TraceSpan span("AppProcessFile", fileEntry.AsView());
+              TraceBytesIn(fileEntry.size);
+              ctx.ProcessFile(*fileStream, appCtx.get());
+            }
 
-          appCtx->outFile = outPath + appCtx->workingFile;
-          ctx.ProcessFile(*fileStream, appCtx.get());
-          (*lines.totalProgress)++;
-          fctx->DisposeFile(fileStream);
+            fctx->DisposeFile(fileStream);
+          }
+
+          if (zipOutputCtx) {
+            TraceSpan span("Merge", fileEntry.AsView());
+            mainZip.Merge(*zipOutputCtx, recordsFile, journalKey);
+            es::Dispose(appCtx->output);
+            es::RemoveFile(recordsFile);
+          } else if (JournalActive()) {
+            JournalDone(journalKey);
+          }
+
+          if (lines.totalProgress) {
+            (*lines.totalProgress)++;
+          }
         }
 #if SPIKE_USE_THREADS
       } catch (const std::exception &e) {
@@ -321,15 +817,33 @@ void ProcessZIPsExtractConvertMode(std::map<std::string, PathFilter> &zips,
     }
 #endif
 
-    if (ctx.info->mode == AppMode_e::EXTRACT &&
-        mainSettings.extractSettings.makeZIP) {
-      ModifyElements([](ElementAPI &api) {
-        api.Clean();
-        api.Append(std::make_unique<LoadingBar>("Generating final ZIP."));
-      });
+    if (zipOutput) {
+      // Shared lines are kept, following ZIPs still report into them
+      auto mergeBar = AppendNewLogLine<LoadingBar>("Generating final ZIP.");
+      TraceSpan span("Finish merge", path);
       mainZip.FinishMerge([] { printinfo("Generating cache."); });
+      mergeBar->Finish();
+      ReleaseLogLines(mergeBar);
+
+      if (JournalActive()) {
+        JournalFinished(outZip);
+      }
+    }
+  }
+}
+
+// Longest input root that contains path
+static std::string InputRoot(const std::vector<std::string> &roots,
+                             es::string_view path) {
+  const std::string *retVal = nullptr;
+
+  for (auto &r : roots) {
+    if (path.begins_with(r) && (!retVal || r.size() > retVal->size())) {
+      retVal = &r;
     }
   }
+
+  return retVal ? *retVal : std::string{};
 }
 
 void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
@@ -344,6 +858,8 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
   }
 
   std::vector<std::string> files;
+  // Overlay keys of loose files are relative to their input root
+  std::vector<std::string> inputRoots;
   std::map<std::string, PathFilter> zips;
 
   for (int a = 2; a < argc; a++) {
@@ -356,6 +872,12 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
 
     switch (type) {
     case FileType_e::Directory: {
+      std::string &root = inputRoots.emplace_back(fileName);
+
+      if (root.back() != '/' && root.back() != '\\') {
+        root.push_back('/');
+      }
+
       auto scanBar = AppendNewLogLine<ScanningFoldersBar>(fileName);
       sc.Clear();
       sc.scanCbData = scanBar;
@@ -364,14 +886,25 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
         auto barData = static_cast<ScanningFoldersBar *>(data);
         barData->Update(numFolders, numFiles, foundFiles);
       };
-      sc.Scan(fileName);
+      {
+        TraceSpan span("Scan", fileName);
+        sc.Scan(fileName);
+      }
       scanBar->Finish();
       ReleaseLogLines(scanBar);
 
-      std::transform(std::make_move_iterator(sc.begin()),
-                     std::make_move_iterator(sc.end()),
-                     std::back_inserter(files),
-                     [](auto &&item) { return std::move(item); });
+      for (auto &item : sc) {
+        es::string_view relPath(item);
+        relPath.remove_prefix(std::min(fileName.size(), relPath.size()));
+
+        if (!relPath.empty() && relPath.front() == '/') {
+          relPath.remove_prefix(1);
+        }
+
+        if (IsInShard(relPath)) {
+          files.emplace_back(std::move(item));
+        }
+      }
 
       break;
     }
@@ -381,7 +914,11 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
         if (found + 4 == fileName.size()) {
           zips.emplace(std::make_pair(std::move(fileName), PathFilter{}));
         } else if (fileName[found + 4] != '/') {
-          files.emplace_back(std::move(fileName));
+          inputRoots.emplace_back(AFileInfo(fileName).GetFolder());
+
+          if (IsInShard(AFileInfo(fileName).GetFilenameExt())) {
+            files.emplace_back(std::move(fileName));
+          }
         } else {
           auto sub = fileName.substr(0, found + 5);
           auto foundZip = zips.find(sub);
@@ -396,7 +933,11 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
           }
         }
       } else {
-        files.emplace_back(std::move(fileName));
+        inputRoots.emplace_back(AFileInfo(fileName).GetFolder());
+
+        if (IsInShard(AFileInfo(fileName).GetFilenameExt())) {
+          files.emplace_back(std::move(fileName));
+        }
       }
       break;
     }
@@ -412,6 +953,67 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
   es::Dispose(markedFiles);
   es::Dispose(sc);
 
+  if (shardSettings.count > 1) {
+    printline("Processing shard " << shardSettings.index + 1 << " of "
+                                  << shardSettings.count);
+  }
+
+  if (spikeOptions.physicalOrder) {
+    SortByPhysicalOffset(files);
+  }
+
+  // Loose CONVERT outputs share one ZIP named after common input folder
+  // Roots are collected before shard filtering, so every shard uses same
+  // ZIP name and entry paths
+  const bool convertZIP =
+      ctx.info->mode == AppMode_e::CONVERT && spikeOptions.convertZIP;
+  std::string convertRoot;
+  std::string convertZipName;
+  ZIPMerger convertZip;
+  bool convertZipStarted = false;
+
+  if (convertZIP && !inputRoots.empty()) {
+    convertRoot = inputRoots.front();
+
+    for (auto &f : inputRoots) {
+      const size_t commonSize =
+          std::mismatch(convertRoot.begin(), convertRoot.end(), f.begin(),
+                        f.end())
+              .first -
+          convertRoot.begin();
+      convertRoot.resize(commonSize);
+    }
+
+    convertRoot.resize(convertRoot.find_last_of('/') + 1);
+    std::string zipBase = convertRoot;
+
+    if (!zipBase.empty()) {
+      zipBase.pop_back();
+    }
+
+    convertZipName = OutputZIPName(zipBase.empty() ? "convert" : zipBase);
+  }
+
+  // Invalid output resets its journaled keys, so it's validated before
+  // inputs are filtered
+  const bool convertZipFinished =
+      !convertZipName.empty() && IsJournaledFinished(convertZipName);
+  const size_t convertResumeSize =
+      convertZipName.empty() ? 0 : JournaledZIPSize(convertZipName);
+
+  // Root is computed from all inputs, so output name stays same on resume
+  if (JournalActive()) {
+    files.erase(std::remove_if(files.begin(), files.end(),
+                               [](auto &item) { return IsJournaledDone(item); }),
+                files.end());
+  }
+
+  if (!convertZipName.empty() && !convertZipFinished &&
+      (!files.empty() || convertResumeSize)) {
+    StartOutputZIP(convertZip, convertZipName, convertResumeSize);
+    convertZipStarted = true;
+  }
+
   if (!files.empty()) {
     printline("Total files to process: " << files.size());
   }
@@ -428,32 +1030,35 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
   uiLines.totalCount = nullptr;
   uiLines.numFiles = files.size();
 
+  // Stats are gathered by workers, total grows as files are processed
+  const bool fusedStat = spikeOptions.fusedStat &&
+                         ctx.info->mode == AppMode_e::EXTRACT &&
+                         ctx.HasExtractStat();
+
   if (ctx.info->mode == AppMode_e::EXTRACT) {
-    if (ctx.ExtractStat) {
-      auto scanBar = AppendNewLogLine<LoadingBar>("Processing extract stats.");
+    if (ctx.HasExtractStat()) {
       archiveFiles.resize(files.size());
-      RunThreadedQueue(files.size(), [&](size_t index) {
-        try {
-          BinReader cRead(files[index]);
-          auto numFiles = ctx.ExtractStat(std::bind(
-              [&](size_t offset, size_t size) {
-                cRead.Seek(offset);
-                std::string data;
-                cRead.ReadContainer(data, size);
-                return data;
-              },
-              std::placeholders::_1, std::placeholders::_2));
 
-          archiveFiles[index] = numFiles;
-          numFilesToProcess.fetch_add(numFiles, std::memory_order_relaxed);
-        } catch (const std::exception &e) {
-          printerror(e.what());
-        }
-      });
+      if (!fusedStat) {
+        auto scanBar =
+            AppendNewLogLine<LoadingBar>("Processing extract stats.");
+        TraceSpan statSpan("Extract stat pass");
+        RunThreadedQueue(files.size(), [&](size_t index) {
+          try {
+            TraceSpan span("AppExtractStat", files[index]);
+            BinReader cRead(files[index]);
+            auto numFiles = ExtractStat(ctx, cRead);
+            archiveFiles[index] = numFiles;
+            numFilesToProcess.fetch_add(numFiles, std::memory_order_relaxed);
+          } catch (const std::exception &e) {
+            printerror(e.what());
+          }
+        });
 
-      ModifyElements([&](ElementAPI &api) {
-        api.Remove(scanBar);
+        RemoveLogLines(scanBar);
+      }
 
+      ModifyElements([&](ElementAPI &api) {
         const size_t minThreads =
             std::min(size_t(std::thread::hardware_concurrency()), files.size());
 
@@ -469,18 +1074,21 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
         }
       });
 
+      // Fused stat starts with estimate of one item per file
+      const size_t numItems =
+          fusedStat ? files.size() : numFilesToProcess.load();
+      uiLines.numFiles = std::max(numItems, size_t(1));
       auto prog = AppendNewLogLine<DetailedProgressBar>("Total: ");
-      prog->ItemCount(std::max(numFilesToProcess.load(), size_t(1)) *
-                      (zips.size() + 1));
+      prog->ItemCount(numItems + uiLines.numFiles * zips.size());
       uiLines.totalCount = prog;
       uiLines.totalProgress = prog;
     } else {
       uiLines.totalCount = AppendNewLogLine<ProcessedFiles>();
     }
   } else {
+    uiLines.numFiles = std::max(files.size(), size_t(1));
     auto prog = AppendNewLogLine<DetailedProgressBar>("Total: ");
-    prog->ItemCount(std::max(files.size(), size_t(1)) *
-                    std::max(zips.size(), size_t(1)));
+    prog->ItemCount(files.size() + uiLines.numFiles * zips.size());
     uiLines.totalCount = prog;
     uiLines.totalProgress = prog;
   }
@@ -491,13 +1099,47 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
 #else
   for (size_t index = 0; index < files.size(); index++) {
 #endif
+      // Whole file is mapped when module accepts buffers
+      const bool useBuffer = ctx.info->mode == AppMode_e::EXTRACT
+                                 ? bool(ctx.ExtractBuffer)
+                                 : bool(ctx.ProcessBuffer);
+      BinReader cRead;
+      es::MappedFile mappedFile;
+      size_t inputSize = 0;
+
+      {
+        TraceSpan span("Open", files[index]);
+
+        if (useBuffer) {
+          mappedFile = es::MappedFile(files[index]);
+          inputSize = mappedFile.dataSize;
+        } else {
+          cRead.Open(files[index]);
+          inputSize = cRead.GetSize();
+        }
+      }
+
+      es::string_view fileData(static_cast<const char *>(mappedFile.data),
+                               mappedFile.dataSize);
+
+      if (fusedStat) {
+        TraceSpan span("AppExtractStat", files[index]);
+        archiveFiles[index] =
+            useBuffer ? ExtractStat(ctx, fileData) : ExtractStat(ctx, cRead);
+        uiLines.totalProgress->AddItemCount(int64(archiveFiles[index]) - 1);
+
+        if (!useBuffer) {
+          cRead.Seek(0);
+        }
+      }
+
       auto currentBar = uiLines.ChooseBar();
+
       if (currentBar) {
         currentBar->ItemCount(archiveFiles.at(index));
       }
-      BinReader cRead(files[index]);
       AFileInfo cFile(files[index]);
-      auto appCtx = MakeIOContext();
+      auto appCtx = MakeIOContext(InputRoot(inputRoots, files[index]));
       appCtx->workingFile = files[index];
 
       if (ctx.info->mode == AppMode_e::EXTRACT) {
@@ -531,17 +1173,65 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
         }
 
         ectx->ctx = appCtx.get();
-        ctx.ExtractFile(cRead.BaseStream(), ectx.get());
+
+        if (useBuffer) {
+          TraceSpan span("AppExtractBuffer", files[index]);
+          TraceBytesIn(inputSize);
+          ctx.ExtractBuffer(fileData, ectx.get());
+        } else {
+          TraceSpan span("AppExtractFile", files[index]);
+          TraceBytesIn(inputSize);
+          ctx.ExtractFile(cRead.BaseStream(), ectx.get());
+        }
 
         if (mainSettings.extractSettings.makeZIP) {
+          TraceSpan span("Finish ZIP", outPath);
           static_cast<ZIPExtactContext *>(ectx.get())->FinishZIP([] {
             printinfo("Generating cache.");
           });
         }
+
+        if (JournalActive()) {
+          JournalDone(files[index]);
+        }
       } else {
         appCtx->outFile = files[index];
         printline("Processing: " << files[index]);
-        ctx.ProcessFile(cRead.BaseStream(), appCtx.get());
+        std::string recordsFile;
+        ZIPExtactContext *zipOutputCtx = nullptr;
+        appCtx->makeOutput = [&]() -> std::unique_ptr<AppExtractContext> {
+          if (!convertZIP) {
+            return std::make_unique<IOExtractContext>(
+                cFile.GetFolder().to_string());
+          }
+
+          recordsFile = RequestTempFile();
+          auto zCtx = std::make_unique<ZIPExtactContext>(recordsFile, false);
+          zCtx->prefixPath = cFile.GetFolder().to_string();
+          zCtx->prefixPath.erase(0, convertRoot.size());
+          zipOutputCtx = zCtx.get();
+          return zCtx;
+        };
+
+        if (useBuffer) {
+          TraceSpan span("AppProcessBuffer", files[index]);
+          TraceBytesIn(inputSize);
+          ctx.ProcessBuffer(fileData, appCtx.get());
+        } else {
+          TraceSpan span("AppProcessFile", files[index]);
+          TraceBytesIn(inputSize);
+          ctx.ProcessFile(cRead.BaseStream(), appCtx.get());
+        }
+
+        if (zipOutputCtx) {
+          TraceSpan span("Merge", files[index]);
+          convertZip.Merge(*zipOutputCtx, recordsFile, files[index]);
+          es::Dispose(appCtx->output);
+          es::RemoveFile(recordsFile);
+        } else if (JournalActive()) {
+          JournalDone(files[index]);
+        }
+
         (*uiLines.totalProgress)++;
       }
 #if SPIKE_USE_THREADS
@@ -553,6 +1243,15 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
   }
 #endif
 
+  if (convertZipStarted) {
+    TraceSpan span("Finish merge");
+    convertZip.FinishMerge([] { printinfo("Generating cache."); });
+
+    if (JournalActive()) {
+      JournalFinished(convertZipName);
+    }
+  }
+
   if (!zips.empty()) {
     size_t curBar = 0;
     decltype(uiLines.bars) newBars;
@@ -567,7 +1266,8 @@ void ExtractConvertMode(int argc, TCHAR *argv[], APPContext &ctx,
     ProcessZIPsExtractConvertMode(zips, pathFilter, ctx, uiLines);
   }
 
-  if (ctx.info->mode == AppMode_e::EXTRACT && !ctx.ExtractStat) {
+  if (ctx.info->mode == AppMode_e::EXTRACT && !ctx.HasExtractStat() &&
+      uiLines.totalCount) {
     auto data = static_cast<ProcessedFiles *>(uiLines.totalCount);
     data->Finish();
     ReleaseLogLines(data);
@@ -606,7 +1306,10 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
         auto barData = static_cast<ScanningFoldersBar *>(data);
         barData->Update(numFolders, numFiles, foundFiles);
       };
-      sc.Scan(fileName);
+      {
+        TraceSpan span("Scan", fileName);
+        sc.Scan(fileName);
+      }
       scanBar->Finish();
       ReleaseLogLines(scanBar);
 
@@ -625,6 +1328,7 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
 
       RunThreadedQueue(sc.Files().size(), [&](size_t index) {
         try {
+          TraceSpan span("SendFile", sc.Files().at(index));
           BinReader cRead(sc.Files().at(index));
           es::string_view relativeFilepath(sc.Files().at(index));
           relativeFilepath.remove_prefix(fileName.size());
@@ -636,7 +1340,10 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
       });
 
       ConsolePrintDetail(1);
-      archiveContext->Finish();
+      {
+        TraceSpan span("Finish archive", fileName);
+        archiveContext->Finish();
+      }
       RemoveLogLines(statBar);
       break;
     }
@@ -681,6 +1388,8 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
     const bool loadFiltered =
         ctx.info->arcLoadType == ArchiveLoadType::FILTERED;
     auto fctx = [&, &paths_ = paths, &path_ = path] {
+      TraceSpan span("Load ZIP index", path_);
+
       if (loadFiltered) {
         PathFilter mainFilter;
         for (auto &z : paths_) {
@@ -738,10 +1447,15 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
           return;
         }
 
-        auto fileStream = fctx->OpenFile(f);
+        auto fileStream = [&] {
+          TraceSpan span("Open", f.AsView());
+          return fctx->OpenFile(f);
+        }();
         es::string_view zFile(f.AsView());
         zFile.remove_prefix(zFolder.size());
         try {
+          TraceSpan span("SendFile", f.AsView());
+          TraceBytesIn(f.size);
           archiveContext->SendFile(f.AsView(), *fileStream);
         } catch (const std::exception &e) {
           printerror(e.what());
@@ -751,12 +1465,75 @@ void PackMode(int argc, TCHAR *argv[], APPContext &ctx,
       });
 
       ConsolePrintDetail(1);
-      archiveContext->Finish();
+      {
+        TraceSpan span("Finish archive", zipPath);
+        archiveContext->Finish();
+      }
       RemoveLogLines(statBar);
     }
   }
 }
 
+// Handle cli options and switches
+// Returns true if any module option was applied, config mustn't be loaded then
+static bool ApplyCLIOptions(int argc, TCHAR *argv[], APPContext &ctx,
+                            std::vector<bool> &markedFiles,
+                            bool serverJob = false) {
+  bool dontLoadConfig = false;
+
+  for (int a = 2; a < argc; a++) {
+    auto opt = argv[a];
+
+    if (int consumed = ApplySpikeOption(argc, argv, a, serverJob);
+        consumed > 0) {
+      a += consumed - 1;
+      continue;
+    }
+
+    if (opt[0] == '-') {
+      // We won't use config file, reset all booleans to false,
+      // so we can properly use cli switches
+      [&] {
+        if (dontLoadConfig) {
+          return;
+        }
+
+        printinfo("CLI option detected, config won't be loaded, all booleans "
+                  "set to false!");
+        ctx.ResetSwitchSettings();
+      }();
+
+      dontLoadConfig = true;
+      opt++;
+
+      if (opt[0] == '-') {
+        opt++;
+      }
+
+      auto optStr = std::to_string(opt);
+      auto valStr = a + 1 < argc ? std::to_string(argv[a + 1]) : std::string{};
+
+      if (auto retVal = ctx.ApplySetting(optStr, valStr); retVal > 0) {
+        a++;
+      }
+
+    } else {
+      markedFiles[a] = true;
+    }
+  }
+
+  return dontLoadConfig;
+}
+
+static void RunModule(int argc, TCHAR *argv[], APPContext &ctx,
+                      const std::vector<bool> &markedFiles) {
+  if (ctx.info->mode == AppMode_e::PACK) {
+    PackMode(argc, argv, ctx, markedFiles);
+  } else {
+    ExtractConvertMode(argc, argv, ctx, markedFiles);
+  }
+}
+
 void ScanModules(const std::string &appFolder, const std::string &appName) {
   DirectoryScanner sc;
   sc.AddFilter(es::string_view(".spk$"));
@@ -828,6 +1605,372 @@ void GenerateDocumentation(const std::string &appFolder,
   }
 }
 
+struct ServerModule {
+  APPContext ctx;
+  pugi::xml_document settings;
+};
+
+using ServerModules = std::map<std::string, ServerModule>;
+
+// Splits job line into arguments, double quotes group whitespace
+static std::vector<std::string> SplitJobLine(es::string_view line) {
+  std::vector<std::string> retVal;
+  std::string current;
+  bool quoted = false;
+  bool hasArg = false;
+
+  for (char c : line) {
+    if (c == '"') {
+      quoted = !quoted;
+      hasArg = true;
+    } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+      if (hasArg) {
+        retVal.emplace_back(std::move(current));
+        current.clear();
+        hasArg = false;
+      }
+    } else {
+      current.push_back(c);
+      hasArg = true;
+    }
+  }
+
+  if (hasArg) {
+    retVal.emplace_back(std::move(current));
+  }
+
+  return retVal;
+}
+
+// Modules are loaded, configured and initialized only once
+// Settings are restored to config state before every job
+static ServerModule &GetServerModule(ServerModules &modules,
+                                     const std::string &name,
+                                     const std::string &appFolder,
+                                     const std::string &appName) {
+  if (auto found = modules.find(name); found != modules.end()) {
+    found->second.ctx.RestoreSettings(found->second.settings);
+    return found->second;
+  }
+
+  // APPContext only references module name, keep it in map key
+  auto [newModule, _] = modules.try_emplace(name);
+
+  try {
+    auto &ctx = newModule->second.ctx;
+    ctx = APPContext(newModule->first.data(), appFolder, appName);
+    printline(ctx.info->header);
+    printinfo("Loading config: " << appName << ".config");
+
+    {
+      TraceSpan span("Load config", name);
+      ctx.FromConfig();
+    }
+
+    {
+      TraceSpan span("Setup module", name);
+      ctx.SetupModule();
+    }
+
+    ctx.StoreSettings(newModule->second.settings);
+  } catch (...) {
+    modules.erase(newModule);
+    throw;
+  }
+
+  return newModule->second;
+}
+
+// Job line: module [options] path1 path2 ...
+static bool RunServerJob(ServerModules &modules, TCHAR *appPath,
+                         es::string_view line, const std::string &appFolder,
+                         const std::string &appName) {
+  auto args = SplitJobLine(line);
+
+  if (args.empty()) {
+    return true;
+  }
+
+  std::vector<TSTRING> jobArgs{appPath};
+
+  for (auto &a : args) {
+    jobArgs.emplace_back(ToTSTRING(a));
+  }
+
+  std::vector<TCHAR *> jobArgv;
+
+  for (auto &a : jobArgs) {
+    jobArgv.push_back(a.data());
+  }
+
+  jobArgv.push_back(nullptr);
+  const int jobArgc = int(jobArgs.size());
+
+  // Job options and folder listings are valid only for this job
+  struct RestoreOptions {
+    SpikeOptions sessionOptions = spikeOptions;
+    ~RestoreOptions() {
+      spikeOptions = std::move(sessionOptions);
+      ReleaseFolderIndexes();
+    }
+  } restoreOptions;
+
+  try {
+    auto &module = GetServerModule(modules, args.front(), appFolder, appName);
+    std::vector<bool> markedFiles(jobArgs.size(), false);
+    ApplyCLIOptions(jobArgc, jobArgv.data(), module.ctx, markedFiles, true);
+    RunModule(jobArgc, jobArgv.data(), module.ctx, markedFiles);
+  } catch (const std::exception &e) {
+    printerror(e.what());
+    return false;
+  }
+
+  return true;
+}
+
+// Reads jobs from stdin or local socket until EOF or "exit" line
+static void RunServer(ServerModules &modules, TCHAR *appPath,
+                      const std::string &socketPath,
+                      const std::string &appFolder,
+                      const std::string &appName) {
+  auto ProcessLine = [&](es::string_view line, bool &running) {
+    if (es::TrimWhitespace(line) == "exit") {
+      running = false;
+      return true;
+    }
+
+    return RunServerJob(modules, appPath, line, appFolder, appName);
+  };
+
+  bool running = true;
+
+  if (socketPath.empty()) {
+    printinfo("Server ready, reading jobs from stdin.");
+    std::string line;
+
+    while (running && std::getline(std::cin, line)) {
+      const bool result = ProcessLine(line, running);
+
+      if (running) {
+        printinfo("Job " << (result ? "finished" : "failed") << ": " << line);
+      }
+    }
+
+    return;
+  }
+
+#if defined(_MSC_VER) || defined(__MINGW64__)
+  throw std::runtime_error("Server sockets are not supported on this system.");
+#else
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path is too long: " + socketPath);
+  }
+
+  memcpy(address.sun_path, socketPath.data(), socketPath.size());
+  const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (server < 0) {
+    throw std::runtime_error("Cannot create server socket.");
+  }
+
+  unlink(socketPath.data());
+
+  if (bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ||
+      listen(server, 8)) {
+    close(server);
+    throw std::runtime_error("Cannot listen on socket: " + socketPath);
+  }
+
+  printinfo("Server ready, listening on: " << socketPath);
+
+  while (running) {
+    const int client = accept(server, nullptr, nullptr);
+
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      break;
+    }
+
+    std::string pending;
+    char buffer[0x1000];
+    ssize_t numRead;
+
+    // Every job is answered with OK or FAIL line
+    while (running && (numRead = read(client, buffer, sizeof(buffer))) > 0) {
+      pending.append(buffer, numRead);
+      size_t lineEnd;
+
+      while (running && (lineEnd = pending.find('\n')) != pending.npos) {
+        auto line = pending.substr(0, lineEnd);
+        pending.erase(0, lineEnd + 1);
+        const bool result = ProcessLine(line, running);
+
+        if (running) {
+          es::string_view reply(result ? "OK\n" : "FAIL\n");
+          [[maybe_unused]] auto written =
+              write(client, reply.data(), reply.size());
+        }
+      }
+    }
+
+    close(client);
+  }
+
+  close(server);
+  unlink(socketPath.data());
+#endif
+}
+
+// Returns false for malformed --shard or unusable --resume journal
+static bool StartSpikeOptions() {
+  if (!spikeOptions.shard.empty()) {
+    const char *shardStr = spikeOptions.shard.c_str();
+    char *indexEnd = nullptr;
+    char *countEnd = nullptr;
+    shardSettings.index = std::strtoull(shardStr, &indexEnd, 10);
+
+    if (indexEnd != shardStr && *indexEnd == '/') {
+      shardSettings.count = std::strtoull(indexEnd + 1, &countEnd, 10);
+    }
+
+    if (!countEnd || countEnd == indexEnd + 1 || *countEnd ||
+        shardSettings.index >= shardSettings.count) {
+      printerror("Invalid --shard " << spikeOptions.shard
+                                    << ", expected <i/n> where i < n");
+      return false;
+    }
+  }
+
+  if (!spikeOptions.journalFile.empty()) {
+    try {
+      StartJournal(spikeOptions.journalFile);
+    } catch (const std::exception &e) {
+      printerror(e.what());
+      return false;
+    }
+  }
+
+  if (!spikeOptions.traceFile.empty()) {
+    StartTracing();
+  }
+
+  if (!spikeOptions.reportFile.empty()) {
+    StartReport();
+  }
+
+  return true;
+}
+
+// Requires temp storage, big ZIP entries are opened through temp files
+static bool MountOverlayLayers() {
+  if (spikeOptions.overlays.empty()) {
+    return true;
+  }
+
+  try {
+    TraceSpan span("Mount overlay");
+    MountOverlay(spikeOptions.overlays);
+  } catch (const std::exception &e) {
+    printerror(e.what());
+    return false;
+  }
+
+  return true;
+}
+
+static void FinishSpikeOptions() {
+  if (!spikeOptions.traceFile.empty()) {
+    WriteTrace(spikeOptions.traceFile);
+    printinfo("Trace written: " << spikeOptions.traceFile);
+  }
+
+  if (!spikeOptions.reportFile.empty()) {
+    WriteReport(spikeOptions.reportFile);
+  }
+}
+
+// spike --server [socket path] [spike options]
+static int ServerMode(int argc, TCHAR *argv[], const std::string &appFolder,
+                      const std::string &appName) {
+  std::string socketPath;
+
+  for (int a = 2; a < argc; a++) {
+    if (int consumed = ApplySpikeOption(argc, argv, a); consumed > 0) {
+      a += consumed - 1;
+    } else {
+      socketPath = std::to_string(argv[a]);
+    }
+  }
+
+  if (!StartSpikeOptions()) {
+    return 1;
+  }
+
+  InitTempStorage();
+
+  if (!MountOverlayLayers()) {
+    return 1;
+  }
+
+  ServerModules modules;
+  int retVal = 0;
+
+  try {
+    RunServer(modules, argv[0], socketPath, appFolder, appName);
+  } catch (const std::exception &e) {
+    printerror(e.what());
+    retVal = 1;
+  }
+
+  for (auto &[name, module] : modules) {
+    if (module.ctx.FinishContext) {
+      TraceSpan span("Finish context", name);
+      module.ctx.FinishContext();
+    }
+  }
+
+  FinishSpikeOptions();
+
+  return retVal;
+}
+
+// spike --merge <output zip> <fragment zips...>
+// Joins ZIP fragments of --shard runs and generates single cache
+static int MergeMode(int argc, TCHAR *argv[]) {
+  if (argc < 4) {
+    printerror("Expected output path and at least one fragment to merge.");
+    return 1;
+  }
+
+  auto outZip = std::to_string(argv[2]);
+  InitTempStorage();
+
+  try {
+    ZIPMerger merger(outZip, RequestTempFile());
+
+    for (int a = 3; a < argc; a++) {
+      auto fragment = std::to_string(argv[a]);
+      printline("Merging: " << fragment);
+      merger.MergeArchive(fragment);
+    }
+
+    merger.FinishMerge([] { printinfo("Generating cache."); });
+  } catch (const std::exception &e) {
+    printerror(e.what());
+    return 1;
+  }
+
+  printinfo("Merged ZIP: " << outZip);
+
+  return 0;
+}
+
 int Main(int argc, TCHAR *argv[]) {
   ConsolePrintDetail(1);
   AFileInfo appLocation(std::to_string(*argv));
@@ -856,6 +1999,14 @@ int Main(int argc, TCHAR *argv[]) {
     return 0;
   }
 
+  if (moduleName == "--server") {
+    return ServerMode(argc, argv, appFolder, appName);
+  }
+
+  if (moduleName == "--merge") {
+    return MergeMode(argc, argv);
+  }
+
   if (argc < 3) {
     printerror("Insufficient argument count, expected parameters.");
     return 1;
@@ -870,7 +2021,6 @@ int Main(int argc, TCHAR *argv[]) {
     return 2;
   }
 
-  bool dontLoadConfig = false;
   std::vector<bool> markedFiles(size_t(argc), false);
   ConsolePrintDetail(0);
 
@@ -880,65 +2030,43 @@ int Main(int argc, TCHAR *argv[]) {
 
   if (IsHelp(argv[2])) {
     ctx.PrintCLIHelp();
+    PrintSpikeOptionsHelp();
     return 0;
   }
 
   ConsolePrintDetail(1);
+  const bool dontLoadConfig = ApplyCLIOptions(argc, argv, ctx, markedFiles);
 
-  // Handle cli options and switches
-  for (int a = 2; a < argc; a++) {
-    auto opt = argv[a];
-
-    if (opt[0] == '-') {
-      // We won't use config file, reset all booleans to false,
-      // so we can properly use cli switches
-      [&] {
-        if (dontLoadConfig) {
-          return;
-        }
-
-        printinfo("CLI option detected, config won't be loaded, all booleans "
-                  "set to false!");
-        ctx.ResetSwitchSettings();
-      }();
-
-      dontLoadConfig = true;
-      opt++;
-
-      if (opt[0] == '-') {
-        opt++;
-      }
-
-      auto optStr = std::to_string(opt);
-      auto valStr = std::to_string(argv[a + 1]);
-
-      if (auto retVal = ctx.ApplySetting(optStr, valStr); retVal > 0) {
-        a++;
-      }
-
-    } else {
-      markedFiles[a] = true;
-    }
+  if (!StartSpikeOptions()) {
+    return 1;
   }
 
   if (!dontLoadConfig) {
     printinfo("Loading config: " << appName << ".config");
+    TraceSpan span("Load config");
     ctx.FromConfig();
   }
 
   InitTempStorage();
-  ctx.SetupModule();
 
-  if (ctx.info->mode == AppMode_e::PACK) {
-    PackMode(argc, argv, ctx, markedFiles);
-  } else {
-    ExtractConvertMode(argc, argv, ctx, markedFiles);
+  if (!MountOverlayLayers()) {
+    return 1;
   }
 
+  {
+    TraceSpan span("Setup module");
+    ctx.SetupModule();
+  }
+
+  RunModule(argc, argv, ctx, markedFiles);
+
   if (ctx.FinishContext) {
+    TraceSpan span("Finish context");
     ctx.FinishContext();
   }
 
+  FinishSpikeOptions();
+
   return 0;
 }
 
@@ -0,0 +1,265 @@
+/*  Spike is universal dedicated module handler
+    This source contains span tracing
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "trace.hpp"
+#include "datas/binwritter.hpp"
+#include "datas/master_printer.hpp"
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+std::atomic_bool spansEnabled{false};
+static bool recordEvents = false;
+static bool collectStats = false;
+
+struct TraceEvent {
+  const char *name;
+  std::string arg;
+  trace_clock::time_point begin;
+  trace_clock::time_point end;
+};
+
+// Worker threads are short lived, lanes of finished threads are reused,
+// so every lane represents one concurrently running worker
+struct TraceLane {
+  size_t laneIndex;
+  bool used = false;
+  std::vector<TraceEvent> events;
+  LaneStats stats;
+  // Stat indices of currently open spans
+  std::vector<size_t> openSpans;
+};
+
+static std::mutex traceRegistryLock;
+static std::vector<std::unique_ptr<TraceLane>> traceRegistry;
+static trace_clock::time_point traceOrigin;
+
+struct ThreadLane {
+  TraceLane *lane = nullptr;
+
+  ~ThreadLane() {
+    if (lane) {
+      std::lock_guard<std::mutex> lg(traceRegistryLock);
+      lane->used = false;
+    }
+  }
+};
+
+static TraceLane &GetThreadLane() {
+  static thread_local ThreadLane threadLane;
+
+  if (!threadLane.lane) {
+    std::lock_guard<std::mutex> lg(traceRegistryLock);
+
+    for (auto &l : traceRegistry) {
+      if (!l->used) {
+        threadLane.lane = l.get();
+        break;
+      }
+    }
+
+    if (!threadLane.lane) {
+      auto &newLane = traceRegistry.emplace_back(std::make_unique<TraceLane>());
+      newLane->laneIndex = traceRegistry.size() - 1;
+      newLane->stats.laneIndex = newLane->laneIndex;
+      threadLane.lane = newLane.get();
+    }
+
+    threadLane.lane->used = true;
+  }
+
+  return *threadLane.lane;
+}
+
+static size_t FindStats(LaneStats &stats, const char *name) {
+  for (size_t i = 0; i < stats.spans.size(); i++) {
+    const char *sName = stats.spans[i].name;
+
+    if (sName == name || !strcmp(sName, name)) {
+      return i;
+    }
+  }
+
+  stats.spans.push_back({name});
+  return stats.spans.size() - 1;
+}
+
+void TraceSpan::Begin(const char *name_, es::string_view arg_) {
+  name = name_;
+
+  if (recordEvents) {
+    arg = arg_;
+  }
+
+  if (collectStats) {
+    auto &lane = GetThreadLane();
+    statIndex = FindStats(lane.stats, name);
+    lane.openSpans.push_back(statIndex);
+  }
+
+  begin = trace_clock::now();
+}
+
+void TraceSpan::End() {
+  auto end = trace_clock::now();
+  auto &lane = GetThreadLane();
+
+  if (statIndex != size_t(-1)) {
+    auto &stat = lane.stats.spans[statIndex];
+    stat.count++;
+    stat.total += end - begin;
+    lane.openSpans.pop_back();
+
+    if (lane.openSpans.empty()) {
+      lane.stats.busy += end - begin;
+    }
+  }
+
+  if (recordEvents) {
+    lane.events.push_back({name, std::move(arg), begin, end});
+  }
+}
+
+void AddSpanBytes(size_t bytesIn, size_t bytesOut) {
+  if (!collectStats) {
+    return;
+  }
+
+  auto &lane = GetThreadLane();
+
+  if (lane.openSpans.empty()) {
+    return;
+  }
+
+  auto &stat = lane.stats.spans[lane.openSpans.back()];
+  stat.bytesIn += bytesIn;
+  stat.bytesOut += bytesOut;
+}
+
+static thread_local std::optional<TraceSpan> printerWaitSpan;
+
+// Producer waits for printer thread to make space in its message queue
+static void PrinterWait(bool begin) {
+  if (begin) {
+    printerWaitSpan.emplace("Printer queue wait");
+  } else {
+    printerWaitSpan.reset();
+  }
+}
+
+static void StartSpans() {
+  if (!spansEnabled) {
+    traceOrigin = trace_clock::now();
+    spansEnabled = true;
+    es::print::AsyncWaitHook(PrinterWait);
+  }
+}
+
+void StartTracing() {
+  recordEvents = true;
+  StartSpans();
+}
+
+void StartSpanStats() {
+  collectStats = true;
+  StartSpans();
+}
+
+trace_clock::time_point SpansOrigin() { return traceOrigin; }
+
+std::vector<LaneStats> CollectSpanStats() {
+  std::lock_guard<std::mutex> lg(traceRegistryLock);
+  std::vector<LaneStats> retVal;
+
+  for (auto &t : traceRegistry) {
+    retVal.push_back(t->stats);
+  }
+
+  return retVal;
+}
+
+static void WriteEscaped(std::ostream &str, es::string_view data) {
+  for (char c : data) {
+    switch (c) {
+    case '"':
+      str << "\\\"";
+      break;
+    case '\\':
+      str << "\\\\";
+      break;
+    case '\n':
+      str << "\\n";
+      break;
+    default:
+      if (uint8(c) < 0x20) {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04X", c);
+        str << buffer;
+      } else {
+        str << c;
+      }
+    }
+  }
+}
+
+void WriteTrace(const std::string &path) {
+  BinWritter_t<BinCoreOpenMode::Text> wr(path);
+  auto &str = wr.BaseStream();
+  std::lock_guard<std::mutex> lg(traceRegistryLock);
+  auto ToUS = [](trace_clock::duration dur) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+  };
+
+  str << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+
+  for (auto &t : traceRegistry) {
+    if (t->events.empty()) {
+      continue;
+    }
+
+    if (!first) {
+      str << ",\n";
+    }
+
+    first = false;
+    str << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << t->laneIndex << ",\"args\":{\"name\":\"lane " << t->laneIndex
+        << "\"}}";
+
+    for (auto &e : t->events) {
+      str << ",\n{\"name\":\"" << e.name
+          << "\",\"cat\":\"spike\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << t->laneIndex << ",\"ts\":" << ToUS(e.begin - traceOrigin)
+          << ",\"dur\":" << ToUS(e.end - e.begin);
+
+      if (!e.arg.empty()) {
+        str << ",\"args\":{\"path\":\"";
+        WriteEscaped(str, e.arg);
+        str << "\"}";
+      }
+
+      str << '}';
+    }
+  }
+
+  str << "\n]}\n";
+}
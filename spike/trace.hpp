@@ -0,0 +1,110 @@
+/*  Spike is universal dedicated module handler
+    Part of PreCore project
+
+    Copyright 2021-2022 Lukas Cone
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+#include "datas/string_view.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using trace_clock = std::chrono::steady_clock;
+
+// Set when either event tracing or span statistics are collected
+extern std::atomic_bool spansEnabled;
+
+// Records time spent within scope into calling thread's lane
+// name must be static string, arg is copied only when tracing events
+struct TraceSpan {
+  TraceSpan(const char *name_, es::string_view arg_ = {}) {
+    if (spansEnabled.load(std::memory_order_relaxed)) {
+      Begin(name_, arg_);
+    }
+  }
+
+  ~TraceSpan() {
+    if (name) {
+      End();
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *name = nullptr;
+  std::string arg;
+  trace_clock::time_point begin;
+  size_t statIndex = -1;
+
+  void Begin(const char *name_, es::string_view arg_);
+  void End();
+};
+
+void AddSpanBytes(size_t bytesIn, size_t bytesOut);
+
+// Attributes consumed bytes to innermost active span of calling thread
+inline void TraceBytesIn(size_t numBytes) {
+  if (spansEnabled.load(std::memory_order_relaxed)) {
+    AddSpanBytes(numBytes, 0);
+  }
+}
+
+// Attributes produced bytes to innermost active span of calling thread
+inline void TraceBytesOut(size_t numBytes) {
+  if (spansEnabled.load(std::memory_order_relaxed)) {
+    AddSpanBytes(0, numBytes);
+  }
+}
+
+struct SpanStats {
+  const char *name;
+  size_t count = 0;
+  size_t bytesIn = 0;
+  size_t bytesOut = 0;
+  trace_clock::duration total{};
+};
+
+struct LaneStats {
+  size_t laneIndex;
+  // Time spent within top level spans
+  trace_clock::duration busy{};
+  std::vector<SpanStats> spans;
+};
+
+void StartTracing();
+void StartSpanStats();
+trace_clock::time_point SpansOrigin();
+// Must be called after all workers are finished
+std::vector<LaneStats> CollectSpanStats();
+// Writes Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+void WriteTrace(const std::string &path);
+
+// Only contended acquisitions are recorded
+template <class mutex_type>
+std::unique_lock<mutex_type> TracedLock(mutex_type &mtx, const char *name) {
+  std::unique_lock<mutex_type> lk(mtx, std::try_to_lock);
+
+  if (!lk) {
+    TraceSpan span(name);
+    lk.lock();
+  }
+
+  return lk;
+}
@@ -1,6 +1,8 @@
 #include "../datas/base_128.hpp"
+#include "../datas/binreader_span.hpp"
 #include "../datas/unit_testing.hpp"
 #include <sstream>
+#include <vector>
 
 int test_base128() {
   std::stringstream ss;
@@ -531,3 +533,84 @@ int test_ubase128() {
 
   return 0;
 }
+
+template <class C, class V> int TestBase128Bulk(const std::vector<V> &values) {
+  std::vector<C> items(values.begin(), values.end());
+  std::stringstream ss;
+  BinWritterRef wr(ss);
+  wr.WriteContainerWCount<buint128>(items);
+  wr.Write(uint8(0xaa));
+
+  // Byte by byte decode of stream
+  BinReaderRef rd(ss);
+  buint128 numItems;
+  rd.Read(numItems);
+  TEST_EQUAL(numItems, values.size());
+
+  for (auto v : values) {
+    C item;
+    rd.Read(item);
+    TEST_EQUAL(item.value, v);
+  }
+
+  // Chunked decode of stream
+  std::vector<C> readItems;
+  rd.Seek(0);
+  rd.ReadContainer<buint128>(readItems);
+  uint8 tail;
+  rd.Read(tail);
+  TEST_EQUAL(tail, 0xaa);
+
+  for (size_t i = 0; i < values.size(); i++) {
+    TEST_EQUAL(readItems[i].value, values[i]);
+  }
+
+  // In place decode of span
+  const std::string data = ss.str();
+  BinReaderSpan srd(data);
+  readItems.clear();
+  srd.ReadContainer<buint128>(readItems);
+  srd.Read(tail);
+  TEST_EQUAL(tail, 0xaa);
+  TEST_CHECK(srd.IsEOF());
+
+  for (size_t i = 0; i < values.size(); i++) {
+    TEST_EQUAL(readItems[i].value, values[i]);
+  }
+
+  return 0;
+}
+
+int test_base128_bulk() {
+  std::vector<int64> values;
+  std::vector<uint64> uvalues;
+
+  for (int64 i = -100; i < 100; i++) {
+    values.push_back(i);
+    uvalues.push_back(i + 100);
+  }
+
+  for (size_t b = 0; b < 64; b++) {
+    const uint64 bit = uint64(1) << b;
+    values.push_back(bit);
+    values.push_back(bit - 1);
+    values.push_back(-int64(bit));
+    values.push_back(-int64(bit) - 1);
+    uvalues.push_back(bit);
+    uvalues.push_back(bit - 1);
+    uvalues.push_back(~bit);
+  }
+
+  // Enough data for multiple chunks
+  for (uint64 i = 0; i < 2000; i++) {
+    const uint64 value = i * 0x9E3779B97F4A7C15;
+    values.push_back(value >> (i % 64));
+    uvalues.push_back(value >> (i % 64));
+  }
+
+  if (int result = TestBase128Bulk<bint128>(values); result) {
+    return result;
+  }
+
+  return TestBase128Bulk<buint128>(uvalues);
+}
@@ -1,5 +1,7 @@
 #include "../datas/binwritter.hpp"
 #include "../datas/binreader.hpp"
+#include "../datas/binreader_span.hpp"
+#include "../datas/binwritter_buffered.hpp"
 #include <sstream>
 
 struct BinStr00 {
@@ -204,3 +206,272 @@ int test_bincore_02() {
 
   return 0;
 };
+
+struct BinStr00_Tp : BinStr00 {
+  template <class rd_type> void Read(rd_type rd) {
+    rd.Read(v0);
+    rd.Read(v3);
+  }
+};
+
+int test_bincore_03() {
+  std::stringstream ss;
+  BinWritterRef_e mwr(ss);
+
+  std::vector<BinStr00_Sw> vec(2);
+  vec[0].v0 = 15;
+  vec[0].v1 = true;
+  vec[0].v2 = 584;
+  vec[0].v3 = 12418651;
+  vec[1].v0 = 79;
+  vec[1].v1 = false;
+  vec[1].v2 = 2100;
+  vec[1].v3 = 4248613;
+
+  mwr.WriteContainerWCount(vec);
+  mwr.ApplyPadding(16);
+  mwr.Write(vec[0].v0);
+  mwr.Write(vec[0].v3);
+  mwr.SwapEndian(true);
+  mwr.WriteContainerWCount(vec);
+
+  const std::string data = ss.str();
+  BinReaderSpan rd(data);
+  BinReaderSpanRef_e mrd(rd);
+
+  TEST_EQUAL(mrd.GetSize(), data.size());
+
+  vec.clear();
+  mrd.ReadContainer(vec);
+
+  TEST_EQUAL(vec.size(), 2);
+  TEST_EQUAL(vec[0].v2, 584);
+  TEST_EQUAL(vec[1].v3, 4248613);
+  TEST_EQUAL(mrd.Tell(), 20);
+
+  mrd.ApplyPadding(16);
+  TEST_EQUAL(mrd.Tell(), 32);
+
+  BinStr00_Tp tst{};
+  mrd.Push();
+  mrd.Read(tst);
+
+  TEST_EQUAL(tst.v0, 15);
+  TEST_EQUAL(tst.v3, 12418651);
+  TEST_EQUAL(mrd.Tell(), 37);
+
+  mrd.Pop();
+  TEST_EQUAL(mrd.Tell(), 32);
+
+  mrd.SetRelativeOrigin(37);
+  TEST_EQUAL(mrd.Tell(), 0);
+
+  mrd.SwapEndian(true);
+  vec.clear();
+  mrd.ReadContainer(vec);
+
+  TEST_EQUAL(vec.size(), 2);
+  TEST_EQUAL(vec[0].v2, 584);
+  TEST_EQUAL(vec[1].v3, 4248613);
+  TEST_CHECK(mrd.IsEOF());
+
+  mrd.Skip(-4);
+  uint32 lastValue;
+  mrd.Read(lastValue);
+  TEST_EQUAL(lastValue, 4248613);
+
+#ifndef NDEBUG
+  TEST_THROW(std::out_of_range, mrd.Read(lastValue););
+#endif
+
+  return 0;
+};
+
+int test_bincore_04() {
+  {
+    BinWritter mwr("testFile.mapped");
+    BinStr00_Fc tst = {};
+    tst.v0 = 15;
+    tst.v3 = 12418651;
+
+    for (size_t i = 0; i < 100; i++) {
+      mwr.Write(tst);
+    }
+  }
+
+  BinReader_t<BinCoreOpenMode::Mapped> mrd("testFile.mapped");
+
+  TEST_EQUAL(mrd.GetSize(), 500);
+  TEST_EQUAL(mrd.Data().size(), 500);
+
+  BinStr00_Fc tst = {};
+  mrd.Seek(495);
+  mrd.Read(tst);
+
+  TEST_EQUAL(tst.v0, 15);
+  TEST_EQUAL(tst.v3, 12418651);
+  TEST_EQUAL(mrd.Tell(), 500);
+
+  mrd.Seek(5);
+  mrd.Skip(-4);
+  uint32 value;
+  mrd.Read(value);
+
+  TEST_EQUAL(value, 12418651);
+
+  auto &str = mrd.BaseStream();
+  str.seekg(-5, std::ios_base::end);
+  str.read(reinterpret_cast<char *>(&tst.v0), 1);
+
+  TEST_EQUAL(tst.v0, 15);
+  TEST_EQUAL(size_t(str.tellg()), 496);
+
+  auto moved = std::move(mrd);
+  moved.Read(value);
+
+  TEST_EQUAL(value, 12418651);
+  TEST_CHECK(moved.BaseStream());
+
+  moved.Read(value);
+  TEST_CHECK(moved.IsEOF());
+
+  TEST_THROW(es::FileNotFoundError,
+             BinReader_t<BinCoreOpenMode::Mapped> mrd2("notAFile.mapped"););
+
+  return 0;
+};
+
+int test_bincore_05() {
+  std::vector<uint32> data(100);
+
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = i;
+  }
+
+  {
+    // Small buffer to hit every flush path
+    BinWritterBuffered wr("testFile.buffered", 64);
+    BinWritterBufferedRef_e mwr(wr);
+    mwr.Write(uint32(0));
+    mwr.Push();
+    mwr.Write(uint32(0));
+    mwr.WriteContainer(data);
+    mwr.Pop();
+    mwr.Write(uint32(data.size()));
+    mwr.Seek(0);
+    mwr.Write(uint32(0xabcd));
+    mwr.Seek(0, std::ios_base::end);
+
+    for (auto d : data) {
+      mwr.Write(d);
+    }
+
+    mwr.SwapEndian(true);
+    mwr.Write(uint32(0x12345678));
+    mwr.Skip(4);
+    mwr.Seek(0, std::ios_base::end);
+    TEST_EQUAL(mwr.Tell(), 816);
+    mwr.Seek(4, std::ios_base::end);
+    mwr.Write(uint8(1));
+    wr.Close();
+  }
+
+  BinReader mrd("testFile.buffered");
+
+  TEST_EQUAL(mrd.GetSize(), 821);
+
+  uint32 value;
+  mrd.Read(value);
+  TEST_EQUAL(value, 0xabcd);
+
+  std::vector<uint32> readData;
+  mrd.ReadContainer(readData);
+  TEST_CHECK(bool(readData == data));
+  readData.clear();
+  mrd.ReadContainer(readData, data.size());
+  TEST_CHECK(bool(readData == data));
+
+  mrd.Read(value);
+  TEST_EQUAL(value, 0x78563412);
+  mrd.Read(value);
+  TEST_EQUAL(value, 0);
+  mrd.Read(value);
+  TEST_EQUAL(value, 0);
+  uint8 lastByte;
+  mrd.Read(lastByte);
+  TEST_EQUAL(lastByte, 1);
+
+  return 0;
+};
+
+int test_bincore_06() {
+  std::vector<uint32> data(1000);
+
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = i;
+  }
+
+  {
+    BinWritter mwr("testFile.readahead");
+    mwr.WriteContainerWCount(data);
+  }
+
+  BinReader_t<BinCoreOpenMode::ReadAhead> mrd;
+  // Small blocks to cross block boundaries and refill after seek
+  mrd.BlockSize(60);
+  mrd.Open("testFile.readahead");
+
+  TEST_EQUAL(mrd.GetSize(), 4004);
+
+  std::vector<uint32> readData;
+  mrd.ReadContainer(readData);
+  TEST_CHECK(bool(readData == data));
+  TEST_EQUAL(mrd.Tell(), 4004);
+
+  uint32 value;
+  mrd.Seek(8);
+  mrd.Read(value);
+  TEST_EQUAL(value, 1);
+
+  mrd.Seek(2004);
+  mrd.Read(value);
+  TEST_EQUAL(value, 500);
+  mrd.Skip(56);
+  mrd.Read(value);
+  TEST_EQUAL(value, 515);
+  mrd.Skip(-8);
+  mrd.Read(value);
+  TEST_EQUAL(value, 514);
+
+  auto moved = std::move(mrd);
+  moved.Seek(4000);
+  moved.Read(value);
+  TEST_EQUAL(value, 999);
+
+  moved.Read(value);
+  TEST_CHECK(moved.IsEOF());
+
+  TEST_THROW(es::FileNotFoundError,
+             BinReader_t<BinCoreOpenMode::ReadAhead> mrd2("notAFile.rd"););
+
+  {
+    BinWritter mwr("testFile.readaheadlast");
+    mwr.WriteContainer(std::vector<uint32>(data.begin(), data.begin() + 30));
+  }
+
+  // Last block was swapped into front, back must not return previous block
+  BinReader_t<BinCoreOpenMode::ReadAhead> lrd;
+  lrd.BlockSize(60);
+  lrd.Open("testFile.readaheadlast");
+  lrd.Read(value);
+  TEST_EQUAL(value, 0);
+  lrd.Seek(64);
+  lrd.Read(value);
+  TEST_EQUAL(value, 16);
+  lrd.Seek(0);
+  lrd.Seek(80);
+  lrd.Read(value);
+  TEST_EQUAL(value, 20);
+
+  return 0;
+};
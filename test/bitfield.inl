@@ -1,6 +1,7 @@
 #include "../datas/bitfield.hpp"
 #include "../datas/endian.hpp"
 #include "../datas/unit_testing.hpp"
+#include <vector>
 
 int test_bf_00() {
   using member0 = BitMemberDecl<0, 2>;
@@ -132,3 +133,46 @@ int test_bf_01() {
 
   return 0;
 }
+
+int test_bf_02() {
+  using member0 = BitMemberDecl<0, 11>;
+  using member1 = BitMemberDecl<1, 11>;
+  using member2 = BitMemberDecl<2, 10>;
+  using BitType = BitFieldType<uint32, member0, member1, member2>;
+
+  // More than one block
+  static constexpr size_t NUM_ITEMS = 3000;
+  std::vector<BitType> values(NUM_ITEMS);
+  std::vector<uint32> members[3];
+
+  for (size_t i = 0; i < NUM_ITEMS; i++) {
+    values[i].value = uint32(i * 0x9E3779B9);
+  }
+
+  for (auto &m : members) {
+    m.resize(NUM_ITEMS);
+  }
+
+  BitType::Unpack(values.data(), NUM_ITEMS,
+                  {members[0].data(), members[1].data(), members[2].data()});
+
+  for (size_t i = 0; i < NUM_ITEMS; i++) {
+    TEST_EQUAL(members[0][i], values[i].Get<member0>());
+    TEST_EQUAL(members[1][i], values[i].Get<member1>());
+    TEST_EQUAL(members[2][i], values[i].Get<member2>());
+  }
+
+  // Out of range bits are masked
+  members[2][0] = 0xffff;
+  std::vector<BitType> packed(NUM_ITEMS);
+  BitType::Pack(packed.data(), NUM_ITEMS,
+                {members[0].data(), members[1].data(), members[2].data()});
+
+  values[0].Set<member2>(0xffff);
+
+  for (size_t i = 0; i < NUM_ITEMS; i++) {
+    TEST_EQUAL(packed[i].value, values[i].value);
+  }
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include "../classgen/classgen.hpp"
+#include "../datas/unit_testing.hpp"
+#include <cstring>
+#include <vector>
+
+#include "classgen_fixture.inl"
+
+// uint32, uint16[2], uint64, uint8, uint16, uint32 + removed member
+static constexpr clgen::SwapPlan<5> CLASSGEN_MIXED_PLAN{
+    {{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {18, 1, 2}, {20, 1, 4}}}};
+// uint32[4]
+static constexpr clgen::SwapPlan<1> CLASSGEN_ARRAY_PLAN{{{{0, 4, 4}}}};
+
+template <size_t N> struct ClassgenTestInterface {
+  char *data;
+  const clgen::ClassData<N> *layout;
+  int16 m(uint32 id) const { return layout->vtable[id]; }
+};
+
+// Planned swap must do the same as vtable walk of walked layout
+template <size_t N>
+int ClassgenCompareSwaps(const clgen::ClassData<N> &walked,
+                         const clgen::ClassData<N> &planned) {
+  constexpr size_t numRecords = 3;
+  const size_t recordSize = walked.totalSize;
+  std::vector<char> source(numRecords * recordSize);
+
+  for (size_t i = 0; i < source.size(); i++) {
+    source[i] = char(i * 7 + 1);
+  }
+
+  std::vector<char> walkedData(source);
+  std::vector<char> plannedData(source);
+
+  // Single record
+  ClassgenTestInterface<N> walkedItem{walkedData.data(), &walked};
+  ClassgenTestInterface<N> plannedItem{plannedData.data(), &planned};
+  clgen::EndianSwap(walkedItem);
+  clgen::EndianSwap(plannedItem);
+
+  TEST_NOT_EQUAL(memcmp(walkedData.data(), source.data(), recordSize), 0);
+  TEST_CHECK(bool(walkedData == plannedData));
+  TEST_EQUAL(memcmp(plannedData.data() + recordSize,
+                    source.data() + recordSize, source.size() - recordSize),
+             0);
+
+  // Array of records
+  walkedData = source;
+  plannedData = source;
+  clgen::EndianSwap(walkedItem, numRecords);
+  clgen::EndianSwap(plannedItem, numRecords);
+
+  const size_t lastRecord = (numRecords - 1) * recordSize;
+  TEST_NOT_EQUAL(memcmp(walkedData.data() + lastRecord,
+                        source.data() + lastRecord, recordSize),
+                 0);
+  TEST_CHECK(bool(walkedData == plannedData));
+
+  return 0;
+}
+
+template <size_t N, const auto &PLAN>
+int ClassgenComparePlan(const clgen::ClassData<N> &walked) {
+  clgen::ClassData<N> planned = walked;
+  planned.swapPlan = clgen::PlannedSwap<PLAN>;
+
+  return ClassgenCompareSwaps(walked, planned);
+}
+
+int test_classgen_00() {
+  clgen::ClassData<8> mixed{};
+  mixed.totalSize = 24;
+  mixed.vtable = {0, 4, 6, 8, 16, 18, 20, -1};
+  mixed.swaps = {2 | 1 << 2 | 1 << 4 | 3 << 6 | 1 << 10 | 2 << 12};
+
+  if (int retVal = ClassgenComparePlan<8, CLASSGEN_MIXED_PLAN>(mixed)) {
+    return retVal;
+  }
+
+  // Hits continuous array path of PlannedSwap
+  clgen::ClassData<4> array{};
+  array.totalSize = 16;
+  array.vtable = {0, 4, 8, 12};
+  array.swaps = {2 | 2 << 2 | 2 << 4 | 2 << 6};
+
+  return ClassgenComparePlan<4, CLASSGEN_ARRAY_PLAN>(array);
+}
+
+// Layouts and plans emitted by classgen.py
+int test_classgen_01() {
+  using namespace clgen::ClassgenFixture;
+
+  for (auto &planned : LAYOUTS) {
+    TEST_CHECK(planned.swapPlan);
+    clgen::ClassData<_count_> walked = planned;
+    walked.swapPlan = nullptr;
+
+    if (int retVal = ClassgenCompareSwaps(walked, planned)) {
+      return retVal;
+    }
+  }
+
+  // Generated accessors agree with swapped layout of every version
+  for (uint8 version = 1; version < 4; version++) {
+    for (bool x64 : {false, true}) {
+      char data[64]{};
+      Interface item(data, {version, x64, false});
+      item.Id(0x11223344);
+      item.Hash(0x1122334455667788);
+      item.Weight(1.f);
+      item.Index(0x1122);
+      clgen::EndianSwap(item);
+
+      TEST_EQUAL(item.Id(), 0x44332211);
+      TEST_EQUAL(item.Hash(), 0x8877665544332211);
+      TEST_EQUAL(item.Index(), version < 3 ? 0 : 0x2211);
+      float weight = item.Weight();
+      FByteswapper(weight);
+      TEST_EQUAL(weight, 1.f);
+    }
+  }
+
+  return 0;
+}
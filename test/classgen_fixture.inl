@@ -0,0 +1,69 @@
+// Generated by classgen_fixture.py, don't edit
+// Run it after changing classgen.py emitter, test_classgen_py checks this file
+namespace clgen::ClassgenFixture {
+enum Members {
+  bone,
+  count,
+  flags,
+  hash,
+  id,
+  index,
+  kind,
+  next,
+  scale,
+  weight,
+  _count_,
+};
+static constexpr SwapPlan<6> SWAP_PLAN_0{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {18, 1, 2}, {24, 1, 8}, {32, 1, 4}}}};
+static constexpr SwapPlan<6> SWAP_PLAN_1{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {16, 1, 2}, {24, 1, 8}, {32, 1, 4}}}};
+static constexpr SwapPlan<8> SWAP_PLAN_2{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {16, 1, 2}, {24, 1, 8}, {32, 1, 4}, {40, 1, 8}, {48, 1, 2}}}};
+static constexpr SwapPlan<5> SWAP_PLAN_3{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {18, 1, 2}, {20, 2, 4}}}};
+static constexpr SwapPlan<5> SWAP_PLAN_4{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {16, 1, 2}, {20, 2, 4}}}};
+static constexpr SwapPlan<7> SWAP_PLAN_5{{{{0, 1, 4}, {4, 2, 2}, {8, 1, 8}, {16, 1, 2}, {20, 2, 4}, {32, 1, 8}, {40, 1, 2}}}};
+static const std::set<ClassData<_count_>> LAYOUTS {
+  {{{{1, 1, 8, 0}}, 40}, {18, 6, 4, 8, 0, -1, 16, 24, -1, 32}, {0xc2d5, 0x8}, PlannedSwap<SWAP_PLAN_0>},
+  {{{{2, 2, 8, 0}}, 40}, {16, 6, 4, 8, 0, -1, -1, 24, -1, 32}, {0xc2d5, 0x8}, PlannedSwap<SWAP_PLAN_1>},
+  {{{{3, 3, 8, 0}}, 56}, {16, 6, 4, 8, 0, 48, -1, 24, 40, 32}, {0xc6d5, 0xb}, PlannedSwap<SWAP_PLAN_2>},
+  {{{{1, 1, 4, 0}}, 32}, {18, 6, 4, 8, 0, -1, 16, 20, -1, 24}, {0x82d5, 0x8}, PlannedSwap<SWAP_PLAN_3>},
+  {{{{2, 2, 4, 0}}, 32}, {16, 6, 4, 8, 0, -1, -1, 20, -1, 24}, {0x82d5, 0x8}, PlannedSwap<SWAP_PLAN_4>},
+  {{{{3, 3, 4, 0}}, 48}, {16, 6, 4, 8, 0, 40, -1, 20, 32, 24}, {0x86d5, 0xb}, PlannedSwap<SWAP_PLAN_5>}
+};
+struct Interface {
+  Interface(char *data_, LayoutLookup layout_): data{data_}, layout{GetLayout(LAYOUTS, {layout_, {LookupFlag::Ptr}})}, lookup{layout_} {}
+  uint16 LayoutVersion() const { return lookup.version; }
+  uint32 Id() const { return m(id) == -1 ? uint32{} : *reinterpret_cast<uint32*>(data + m(id)); }
+  uint16 Flags() const { return m(flags) == -1 ? uint16{} : *reinterpret_cast<uint16*>(data + m(flags)); }
+  uint16 Count() const { return m(count) == -1 ? uint16{} : *reinterpret_cast<uint16*>(data + m(count)); }
+  uint64 Hash() const { return m(hash) == -1 ? uint64{} : *reinterpret_cast<uint64*>(data + m(hash)); }
+  uint8 Kind() const { return m(kind) == -1 ? uint8{} : *reinterpret_cast<uint8*>(data + m(kind)); }
+  int16 Bone() const { return m(bone) == -1 ? int16{} : *reinterpret_cast<int16*>(data + m(bone)); }
+  float *Next() {
+    int16 off = m(next); if (off == -1) return nullptr;
+    if (layout->ptrSize == 8) return *reinterpret_cast<float**>(data + off);
+    return *reinterpret_cast<es::PointerX86<float>*>(data + off);
+  }
+  const float *Next() const {
+    int16 off = m(next); if (off == -1) return nullptr;
+    if (layout->ptrSize == 8) return *reinterpret_cast<float**>(data + off);
+    return *reinterpret_cast<es::PointerX86<float>*>(data + off);
+  }
+  float Weight() const { return m(weight) == -1 ? float{} : *reinterpret_cast<float*>(data + m(weight)); }
+  double Scale() const { return m(scale) == -1 ? double{} : *reinterpret_cast<double*>(data + m(scale)); }
+  uint16 Index() const { return m(index) == -1 ? uint16{} : *reinterpret_cast<uint16*>(data + m(index)); }
+  void Id(uint32 value) { if (m(id) >= 0) *reinterpret_cast<uint32*>(data + m(id)) = value; }
+  void Flags(uint16 value) { if (m(flags) >= 0) *reinterpret_cast<uint16*>(data + m(flags)) = value; }
+  void Count(uint16 value) { if (m(count) >= 0) *reinterpret_cast<uint16*>(data + m(count)) = value; }
+  void Hash(uint64 value) { if (m(hash) >= 0) *reinterpret_cast<uint64*>(data + m(hash)) = value; }
+  void Kind(uint8 value) { if (m(kind) >= 0) *reinterpret_cast<uint8*>(data + m(kind)) = value; }
+  void Bone(int16 value) { if (m(bone) >= 0) *reinterpret_cast<int16*>(data + m(bone)) = value; }
+  void Weight(float value) { if (m(weight) >= 0) *reinterpret_cast<float*>(data + m(weight)) = value; }
+  void Scale(double value) { if (m(scale) >= 0) *reinterpret_cast<double*>(data + m(scale)) = value; }
+  void Index(uint16 value) { if (m(index) >= 0) *reinterpret_cast<uint16*>(data + m(index)) = value; }
+
+
+  int16 m(uint32 id) const { return layout->vtable[id]; }
+  char *data;
+  const ClassData<_count_> *layout;
+  LayoutLookup lookup;
+};
+} // namespace clgen::ClassgenFixture
@@ -0,0 +1,57 @@
+import os
+import sys
+
+sys.dont_write_bytecode = True
+
+here = os.path.dirname(os.path.abspath(__file__))
+sys.path.append(os.path.join(here, '..', 'classgen'))
+
+from classgen import *
+
+fixture_path = os.path.join(here, 'classgen_fixture.inl')
+
+# Version 2 drops a member, version 3 appends members of different sizes
+settings = MainSettings()
+settings.permutators = [1, 2, 3]
+settings.pointer_x64 = True
+settings.pointer_x86 = True
+settings.class_layout_gnu = True
+
+fixture = ClassData('ClassgenFixture')
+fixture.members = [
+    ClassMember('id', TYPES.uint32),
+    ClassMember('flags', TYPES.uint16),
+    ClassMember('count', TYPES.uint16),
+    ClassMember('hash', TYPES.uint64),
+    ClassMember('kind', TYPES.uint8),
+    ClassMember('bone', TYPES.int16),
+    ClassMember('next', Pointer(TYPES.float)),
+    ClassMember('weight', TYPES.float),
+]
+fixture.patches = [
+    ClassPatch(2, ClassPatchType.delete, 'kind'),
+    ClassPatch(3, ClassPatchType.append, ClassMember('scale', TYPES.double),
+               ClassMember('index', TYPES.uint16)),
+]
+
+
+def gen_fixture():
+    return '''// Generated by classgen_fixture.py, don't edit
+// Run it after changing classgen.py emitter, test_classgen_py checks this file
+namespace clgen::ClassgenFixture {
+%s
+%s
+%s
+} // namespace clgen::ClassgenFixture
+''' % (fixture.gen_enum_cpp(), fixture.gen_table_cpp(settings),
+       fixture.gen_interface_cpp(settings))
+
+
+generated = gen_fixture()
+
+if len(sys.argv) > 1 and sys.argv[1] == '--check':
+    with open(fixture_path, newline='\n') as f:
+        assert f.read() == generated, 'classgen_fixture.inl is out of date'
+else:
+    with open(fixture_path, 'w', newline='\n') as f:
+        f.write(generated)
@@ -61,4 +61,58 @@ int test_endian() {
     TEST_EQUAL(test.items0[2], 0x32547698);
 
     return 0;
-}
\ No newline at end of file
+}
+template <class C> int test_endian_bulk() {
+  // Odd count covers vector and scalar tails
+  C items[67];
+  C swapped[67];
+
+  for (size_t i = 0; i < 67; i++) {
+    items[i] = swapped[i] = C(0x0102030405060708ULL * (i + 1));
+    FByteswapper(swapped[i]);
+  }
+
+  FArraySwapper(items, 67);
+
+  for (size_t i = 0; i < 67; i++) {
+    TEST_EQUAL(items[i], swapped[i]);
+  }
+
+  return 0;
+}
+
+struct endianUniformTest {
+  using swap_item_type = uint16;
+  uint16 field0;
+  uint16 field1;
+
+  void SwapEndian() {
+    FByteswapper(field0);
+    FByteswapper(field1);
+  }
+};
+
+int test_endian_01() {
+  TEST_EQUAL(test_endian_bulk<uint16>(), 0);
+  TEST_EQUAL(test_endian_bulk<uint32>(), 0);
+  TEST_EQUAL(test_endian_bulk<uint64>(), 0);
+
+  static_assert(IsSwapableUniform<endianUniformTest>);
+  static_assert(!IsSwapableUniform<endianTest>);
+
+  endianUniformTest items[9];
+
+  for (size_t i = 0; i < 9; i++) {
+    items[i].field0 = 0x1234 + i;
+    items[i].field1 = 0x5678 + i;
+  }
+
+  FByteswapper(items);
+
+  for (size_t i = 0; i < 9; i++) {
+    TEST_EQUAL(items[i].field0, _fbswap<uint16>(0x1234 + i));
+    TEST_EQUAL(items[i].field1, _fbswap<uint16>(0x5678 + i));
+  }
+
+  return 0;
+}
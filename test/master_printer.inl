@@ -0,0 +1,90 @@
+#include "../datas/master_printer.hpp"
+#include "../datas/multi_thread.hpp"
+#include "../datas/unit_testing.hpp"
+#include <atomic>
+#include <map>
+
+static std::atomic_size_t mpNumQueued{0};
+static std::map<size_t, size_t> mpLastIndex;
+static bool mpOrdered = true;
+
+static void MPTestQueuer(const es::print::Queuer &que) {
+  if (que.payload.find("mp_test ") != 0) {
+    return;
+  }
+
+  // Called from single printer thread, no locking needed
+  char *next = nullptr;
+  const size_t task = std::strtoull(que.payload.data() + 8, &next, 10);
+  const size_t index = std::strtoull(next, nullptr, 10);
+  auto found = mpLastIndex.find(task);
+
+  if (found != mpLastIndex.end()) {
+    mpOrdered &= found->second < index;
+    found->second = index;
+  } else {
+    mpLastIndex.emplace(task, index);
+  }
+
+  mpNumQueued++;
+}
+
+static std::atomic_size_t mpNumWaits{0};
+static std::atomic_size_t mpNumWaitsDone{0};
+
+static void MPTestWait(bool begin) { (begin ? mpNumWaits : mpNumWaitsDone)++; }
+
+int test_mp_async00() {
+  const size_t numTasks = 8;
+  const size_t numLines = 100;
+  es::print::AddQueuer(MPTestQueuer);
+  es::print::AsyncWaitHook(MPTestWait);
+  es::print::StartAsync(16);
+
+  RunThreadedQueue(numTasks, [&](size_t task) {
+    for (size_t i = 0; i < numLines; i++) {
+      es::print::Get(es::print::MPType::PREV)
+          << "mp_test " << task << ' ' << i << std::endl;
+      es::print::FlushAll();
+    }
+  });
+
+  // Everything is queued before printer is stopped
+  es::print::WaitAsync();
+  TEST_EQUAL(mpNumQueued, numTasks * numLines);
+
+  es::print::StopAsync();
+  es::print::AsyncWaitHook(nullptr);
+
+  TEST_EQUAL(mpNumQueued, numTasks * numLines);
+  TEST_CHECK(mpOrdered);
+  TEST_EQUAL(mpNumWaits, mpNumWaitsDone);
+
+  return 0;
+}
+
+int test_mp_filter00() {
+  mpNumQueued = 0;
+  mpLastIndex.clear();
+  es::print::LevelMask(1 << int(es::print::MPType::ERR));
+
+  TEST_CHECK(!es::print::LevelEnabled(es::print::MPType::MSG));
+  TEST_CHECK(es::print::LevelEnabled(es::print::MPType::ERR));
+
+  size_t numEvaluated = 0;
+  auto Eval = [&] { return ++numEvaluated; };
+  printline("mp_test 0 " << Eval());
+  printwarning("mp_test 0 " << Eval());
+
+  es::print::LevelMask(0xff);
+
+  TEST_EQUAL(numEvaluated, 0);
+  TEST_EQUAL(mpNumQueued, 0);
+
+  printline("mp_test 0 " << Eval());
+
+  TEST_EQUAL(numEvaluated, 1);
+  TEST_EQUAL(mpNumQueued, 1);
+
+  return 0;
+}
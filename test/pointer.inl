@@ -0,0 +1,59 @@
+#include "../datas/pointer.hpp"
+#include "../datas/unit_testing.hpp"
+#include <set>
+
+struct PointerTestItem {
+  es::PointerX86<uint32> x86;
+  es::PointerX64<uint32> x64;
+};
+
+struct PointerTestBuffer {
+  PointerTestItem items[4];
+  uint32 data[4] = {1, 2, 3, 4};
+};
+
+int test_pointer_00() {
+  PointerTestBuffer buffer;
+  auto &items = buffer.items;
+  auto &data = buffer.data;
+  char *root = reinterpret_cast<char *>(&buffer);
+  const int32 dataOffset = reinterpret_cast<char *>(data) - root;
+  es::PointerRelocator reloc(root);
+
+  for (int32 i = 0; i < 4; i++) {
+    // stored as offset from root
+    const int32 offset = i < 3 ? dataOffset + i * 4 : 0;
+    items[i].x86.Reset(offset);
+    const uint64 offset64 = offset;
+    memcpy(reinterpret_cast<char *>(&items[i].x64), &offset64, 8);
+    reloc.Add(items[i].x86);
+  }
+
+  // duplicate entries from relocation table
+  const size_t table[]{offsetof(PointerTestItem, x86),
+                       sizeof(PointerTestItem) + offsetof(PointerTestItem, x86)};
+  reloc.AddTable(table);
+
+  TEST_EQUAL(reloc.FixupX86(), 4);
+
+  for (int32 i = 0; i < 3; i++) {
+    TEST_EQUAL(items[i].x86.Get(), data + i);
+  }
+
+  TEST_CHECK(!items[3].x86);
+
+  // already fixed locations are skipped
+  reloc.Add(items[0].x86);
+  reloc.Add(items[1].x64);
+  TEST_EQUAL(reloc.FixupX64(), 1);
+  TEST_EQUAL(items[0].x86.Get(), data);
+  TEST_EQUAL(static_cast<uint32 *>(items[1].x64), data + 1);
+  TEST_EQUAL(reloc.NumFixed(), 5);
+
+  std::set<uint64 *> stored;
+  TEST_EQUAL(items[2].x64.Fixup(root, &stored), 1);
+  TEST_EQUAL(items[2].x64.Fixup(root, &stored), -1);
+  TEST_EQUAL(static_cast<uint32 *>(items[2].x64), data + 2);
+
+  return 0;
+}
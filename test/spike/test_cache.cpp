@@ -1,9 +1,12 @@
+#include "datas/binreader.hpp"
 #include "datas/binwritter.hpp"
 #include "datas/directory_scanner.hpp"
 #include "datas/stat.hpp"
 #include "datas/supercore.hpp"
 #include "datas/unit_testing.hpp"
 #include "spike/cache.hpp"
+#include "spike/journal.hpp"
+#include <sstream>
 
 int test_dirscan() {
   DirectoryScanner sc;
@@ -43,6 +46,46 @@ int test_dirscan() {
   return 0;
 }
 
+// Finished and unfinished outputs were never made, their keys must be
+// processed again
+int test_journal_missing_output() {
+  const std::string journalFile = "journal.spjr";
+  const std::string finishedZip = "journal_finished_out.zip";
+  const std::string partialZip = "journal_partial_out.zip";
+
+  {
+    BinWritter_t<BinCoreOpenMode::Text> wr(journalFile);
+    wr.BaseStream() << "M\t" << finishedZip << "\t100\tfinished.zip/a.txt\n"
+                    << "F\t" << finishedZip << '\n'
+                    << "M\t" << partialZip << "\t100\tpartial.zip/a.txt\n"
+                    << "D\tloose.txt\n";
+  }
+
+  StartJournal(journalFile);
+
+  TEST_CHECK(IsJournaledDone("finished.zip/a.txt"));
+  TEST_NOT_CHECK(IsJournaledFinished(finishedZip));
+  TEST_NOT_CHECK(IsJournaledDone("finished.zip/a.txt"));
+
+  TEST_CHECK(IsJournaledDone("partial.zip/a.txt"));
+  TEST_EQUAL(JournaledZIPSize(partialZip), 0);
+  TEST_NOT_CHECK(IsJournaledDone("partial.zip/a.txt"));
+
+  TEST_CHECK(IsJournaledDone("loose.txt"));
+
+  // Resets are journaled, so next resume won't skip keys again
+  BinReader_t<BinCoreOpenMode::Text> rd(journalFile);
+  std::stringstream str;
+  str << rd.BaseStream().rdbuf();
+  const std::string journalData = str.str();
+  TEST_NOT_EQUAL(journalData.find("R\t" + finishedZip + '\n'),
+                 std::string::npos);
+  TEST_NOT_EQUAL(journalData.find("R\t" + partialZip + '\n'),
+                 std::string::npos);
+
+  return 0;
+}
+
 int main() {
   setlocale(LC_ALL, "C.UTF-8");
   setlocale(LC_NUMERIC, "en-US");
@@ -51,7 +94,8 @@ int main() {
 
   printline("Printed some line into console and logger.");
 
-  TEST_CASES(int testResult, TEST_FUNC(test_dirscan));
+  TEST_CASES(int testResult, TEST_FUNC(test_dirscan),
+             TEST_FUNC(test_journal_missing_output));
 
   return testResult;
 }
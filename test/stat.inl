@@ -0,0 +1,64 @@
+#include "../datas/except.hpp"
+#include "../datas/stat.hpp"
+#include "../datas/unit_testing.hpp"
+#include <cstring>
+
+int test_mapped_00() {
+  static constexpr size_t FILE_SIZE = 0x3000;
+  static constexpr size_t WINDOW_OFFSET = 0x1234;
+
+  {
+    es::MappedFile output("testFile.mapout", es::MappedFile::Mode::ReadWrite);
+    output.Resize(0);
+    TEST_EQUAL(output.dataSize, 0);
+    TEST_CHECK(!output.data);
+    output.Resize(FILE_SIZE);
+    TEST_EQUAL(output.dataSize, FILE_SIZE);
+
+    auto data = static_cast<uint8 *>(output.data);
+
+    for (size_t i = 0; i < FILE_SIZE; i++) {
+      data[i] = uint8(i);
+    }
+
+    output.Sync();
+  }
+
+  es::MappedFile whole("testFile.mapout");
+  TEST_EQUAL(whole.dataSize, FILE_SIZE);
+  TEST_EQUAL(static_cast<uint8 *>(whole.data)[FILE_SIZE - 1], 0xff);
+
+  // Unaligned window
+  es::MappedFile window("testFile.mapout", es::MappedFile::Mode::Read,
+                        WINDOW_OFFSET, 0x100);
+  window.Advise(es::MappedFile::Access::Sequential);
+  window.Advise(es::MappedFile::Access::HugePages);
+  TEST_EQUAL(window.dataSize, 0x100);
+  TEST_EQUAL(static_cast<uint8 *>(window.data)[0], 0x34);
+  TEST_CHECK(!memcmp(window.data, static_cast<char *>(whole.data) +
+                                      WINDOW_OFFSET, 0x100));
+
+  // Window is clamped to end of file
+  es::MappedFile tail("testFile.mapout", es::MappedFile::Mode::Read,
+                      FILE_SIZE - 0x10, 0x100, true);
+  TEST_EQUAL(tail.dataSize, 0x10);
+
+  {
+    es::MappedFile patched("testFile.mapout",
+                           es::MappedFile::Mode::CopyOnWrite, WINDOW_OFFSET);
+    TEST_EQUAL(patched.dataSize, FILE_SIZE - WINDOW_OFFSET);
+    static_cast<uint8 *>(patched.data)[0] = 0xaa;
+    TEST_EQUAL(static_cast<uint8 *>(patched.data)[0], 0xaa);
+    TEST_THROW(std::runtime_error, patched.Resize(0x100););
+  }
+
+  TEST_EQUAL(static_cast<uint8 *>(window.data)[0], 0x34);
+
+  TEST_THROW(std::runtime_error,
+             es::MappedFile("testFile.mapout", es::MappedFile::Mode::Read,
+                            FILE_SIZE + 1););
+  TEST_THROW(es::FileNotFoundError,
+             es::MappedFile("notAFile.mapout", es::MappedFile::Mode::Read););
+
+  return 0;
+}
@@ -3,12 +3,16 @@
 
 #include "allocator_hybrid.inl"
 #include "bitfield.inl"
+#include "classgen.inl"
 #include "endian.inl"
 #include "fileinfo.inl"
 #include "flags.inl"
+#include "master_printer.inl"
 #include "float.inl"
 #include "matrix44.inl"
 #include "multi_thread.inl"
+#include "pointer.inl"
+#include "stat.inl"
 #include "vector_simd.inl"
 
 #include "base128.inl"
@@ -27,19 +31,25 @@ int main() {
   printinfo("I'm blue, da ri di danu da.");
 
   TEST_CASES(int testResult, TEST_FUNC(test_bf_00), TEST_FUNC(test_bf_01),
-             TEST_FUNC(test_alloc_hybrid), TEST_FUNC(test_fileinfo),
-             TEST_FUNC(test_endian), TEST_FUNC(test_flags_00),
+             TEST_FUNC(test_bf_02), TEST_FUNC(test_alloc_hybrid),
+             TEST_FUNC(test_fileinfo), TEST_FUNC(test_endian),
+             TEST_FUNC(test_endian_01), TEST_FUNC(test_flags_00),
              TEST_FUNC(test_flags_01), TEST_FUNC(test_flags_02),
              TEST_FUNC(test_bincore_00), TEST_FUNC(test_bincore_01),
-             TEST_FUNC(test_bincore_02), TEST_FUNC(test_matrix44_00),
+             TEST_FUNC(test_bincore_02), TEST_FUNC(test_bincore_03),
+             TEST_FUNC(test_bincore_04), TEST_FUNC(test_bincore_05),
+             TEST_FUNC(test_bincore_06), TEST_FUNC(test_matrix44_00),
              TEST_FUNC(test_matrix44_01), TEST_FUNC(test_matrix44_02),
              TEST_FUNC(test_float_00), TEST_FUNC(test_float_01),
              TEST_FUNC(test_vector_simd_00), TEST_FUNC(test_vector_simd_01),
              TEST_FUNC(test_vector_simd_02), TEST_FUNC(test_vector_simd_03),
              TEST_FUNC(test_vector_simd_10), TEST_FUNC(test_vector_simd_11),
              TEST_FUNC(test_vector_simd_12), TEST_FUNC(test_mt_thread00),
-             TEST_FUNC(test_mt_thread01), TEST_FUNC(test_base128),
-             TEST_FUNC(test_ubase128));
+             TEST_FUNC(test_mt_thread01), TEST_FUNC(test_mp_async00),
+             TEST_FUNC(test_mp_filter00), TEST_FUNC(test_pointer_00),
+             TEST_FUNC(test_classgen_00), TEST_FUNC(test_classgen_01),
+             TEST_FUNC(test_mapped_00), TEST_FUNC(test_base128),
+             TEST_FUNC(test_ubase128), TEST_FUNC(test_base128_bulk));
 
   return testResult;
 }